@@ -0,0 +1,499 @@
+#include "abstractnetwork.h"
+
+#include "reconciliation.h"
+
+#include <algorithm>
+
+NS_LOG_COMPONENT_DEFINE("AbstractNetwork");
+
+AbstractNetwork::AbstractNetwork()
+    : deliveriesSent(0),
+      eventsScheduled(0),
+      bytesSent(0),
+      payloadBytes(0),
+      chunkBytes(0),
+      chunkCount(1),
+      cutThrough(false),
+      components(0),
+      poolOverlap(1.0),
+      reconciliation(nullptr),
+      coded(false),
+      codingKernel(Gf256Kernel::Scalar)
+{
+}
+
+void AbstractNetwork::SetReceiveCallback(ReceiveCallback callback)
+{
+    receiver = callback;
+}
+
+void AbstractNetwork::SetAccessLink(uint32_t node, DataRate uplink, DataRate downlink)
+{
+    if (accessLinks.size() <= node)
+    {
+        accessLinks.resize(node + 1);
+    }
+    accessLinks[node] =
+        AccessLink{uplink, downlink, Time(), Time(), Time(), Time(), false, EventId(), EventId()};
+}
+
+bool AbstractNetwork::HasAccessLinks() const
+{
+    return !accessLinks.empty();
+}
+
+void AbstractNetwork::SetFairQueueing(uint32_t quantumBytes,
+                                      double rateBytesPerSecond,
+                                      uint32_t burstBytes)
+{
+    scheduler = std::make_unique<OutboundScheduler>(quantumBytes, rateBytesPerSecond, burstBytes);
+}
+
+const OutboundScheduler::Stats* AbstractNetwork::GetFairQueueingStats() const
+{
+    return scheduler ? &scheduler->GetStats() : nullptr;
+}
+
+void AbstractNetwork::Send(MessageKind kind,
+                           uint32_t fromNode,
+                           uint32_t toNode,
+                           const Share& share,
+                           uint32_t value,
+                           Time delay,
+                           uint32_t bytes)
+{
+    if (kind == MessageKind::CompactShare)
+    {
+        // What the same announcement would have cost as a full share
+        compact.fullBytes += bytes - GetCompactBodyBytes(kind, value) + payloadBytes;
+    }
+    if (kind == MessageKind::CompactShare || kind == MessageKind::GetComponents ||
+        kind == MessageKind::Components)
+    {
+        compact.compactBytes += bytes;
+    }
+    if (kind == MessageKind::Decoded)
+    {
+        coding.notices++;
+    }
+    if (reconciliation && kind == MessageKind::Share &&
+        reconciliation->Absorb(fromNode, toNode, share, bytes))
+    {
+        return;
+    }
+    Transmit(kind, fromNode, toNode, share, value, delay, bytes);
+}
+
+void AbstractNetwork::Transmit(MessageKind kind,
+                               uint32_t fromNode,
+                               uint32_t toNode,
+                               const Share& share,
+                               uint32_t value,
+                               Time delay,
+                               uint32_t bytes)
+{
+    deliveriesSent++;
+    bytesSent += bytes;
+    if (scheduler && !accessLinks.empty())
+    {
+        scheduler->Push(fromNode,
+                        OutboundScheduler::Outgoing{Delivery{share, fromNode, bytes, kind, value},
+                                                    toNode,
+                                                    delay,
+                                                    Simulator::Now()});
+        ServeUplink(fromNode);
+        return;
+    }
+    Time arrival = delay;
+    if (!accessLinks.empty())
+    {
+        AccessLink& link = accessLinks[fromNode];
+        Time now = Simulator::Now();
+        Time start = std::max(now, link.uplinkFreeAt);
+        Time txTime = link.uplink.CalculateBytesTxTime(bytes);
+        link.uplinkFreeAt = start + txTime;
+        link.uplinkBusy += txTime;
+        uplinkWait.Add((start - now).GetSeconds());
+        arrival = link.uplinkFreeAt - now + delay;
+    }
+    Enqueue(pending, arrival, toNode, Delivery{share, fromNode, bytes, kind, value},
+            &AbstractNetwork::DeliverBatch);
+}
+
+void AbstractNetwork::ServeUplink(uint32_t node)
+{
+    AccessLink& link = accessLinks[node];
+    if (link.transmitting)
+    {
+        return;
+    }
+    Time now = Simulator::Now();
+    OutboundScheduler::Outgoing next;
+    Time wakeAt;
+    if (!scheduler->Pop(node, now, next, wakeAt))
+    {
+        if (!wakeAt.IsZero() && !link.wakeup.IsPending())
+        {
+            link.wakeup =
+                Simulator::Schedule(wakeAt - now, &AbstractNetwork::ServeUplink, this, node);
+        }
+        return;
+    }
+    Time txTime = link.uplink.CalculateBytesTxTime(next.delivery.bytes);
+    link.uplinkBusy += txTime;
+    uplinkWait.Add((now - next.queuedAt).GetSeconds());
+    link.transmitting = true;
+    link.transmission =
+        Simulator::Schedule(txTime, &AbstractNetwork::FinishUplink, this, node, next);
+}
+
+void AbstractNetwork::FinishUplink(uint32_t node, OutboundScheduler::Outgoing message)
+{
+    accessLinks[node].transmitting = false;
+    Enqueue(pending, message.delay, message.toNode, message.delivery,
+            &AbstractNetwork::DeliverBatch);
+    ServeUplink(node);
+}
+
+void AbstractNetwork::Enqueue(BatchMap& batches,
+                              Time delay,
+                              uint32_t toNode,
+                              const Delivery& delivery,
+                              void (AbstractNetwork::*handler)(BatchKey))
+{
+    BatchKey key{(Simulator::Now() + delay).GetTimeStep(), toNode};
+    Batch& batch = batches[key];
+    if (batch.deliveries.empty())
+    {
+        batch.event = Simulator::Schedule(delay, handler, this, key);
+        eventsScheduled++;
+    }
+    batch.deliveries.push_back(delivery);
+}
+
+std::vector<Delivery> AbstractNetwork::TakeBatch(BatchMap& batches, BatchKey key)
+{
+    auto it = batches.find(key);
+    NS_ASSERT(it != batches.end());
+    std::vector<Delivery> batch = std::move(it->second.deliveries);
+    batches.erase(it);
+    return batch;
+}
+
+void AbstractNetwork::DeliverBatch(BatchKey key)
+{
+    std::vector<Delivery> batch = TakeBatch(pending, key);
+    if (accessLinks.empty())
+    {
+        NS_LOG_LOGIC("Delivering " << batch.size() << " shares to node " << key.toNode);
+        Dispatch(key.toNode, batch);
+        return;
+    }
+
+    // Shares arriving at the access router queue for the downlink in arrival order
+    AccessLink& link = accessLinks[key.toNode];
+    Time now = Simulator::Now();
+    for (const Delivery& delivery : batch)
+    {
+        Time start = std::max(now, link.downlinkFreeAt);
+        Time txTime = link.downlink.CalculateBytesTxTime(delivery.bytes);
+        link.downlinkFreeAt = start + txTime;
+        link.downlinkBusy += txTime;
+        downlinkWait.Add((start - now).GetSeconds());
+        Enqueue(downloading, link.downlinkFreeAt - now, key.toNode, delivery,
+                &AbstractNetwork::CompleteDownload);
+    }
+}
+
+void AbstractNetwork::CompleteDownload(BatchKey key)
+{
+    std::vector<Delivery> batch = TakeBatch(downloading, key);
+    NS_LOG_LOGIC("Delivering " << batch.size() << " shares to node " << key.toNode);
+    Dispatch(key.toNode, batch);
+}
+
+void AbstractNetwork::Dispatch(uint32_t toNode, const std::vector<Delivery>& batch)
+{
+    if (!reconciliation)
+    {
+        receiver(toNode, batch);
+        return;
+    }
+    std::vector<Delivery> forNode;
+    forNode.reserve(batch.size());
+    for (const Delivery& delivery : batch)
+    {
+        switch (delivery.kind)
+        {
+        case MessageKind::ReconcileRequest:
+        case MessageKind::Sketch:
+        case MessageKind::ReconcileFinish:
+            reconciliation->Receive(toNode, delivery);
+            break;
+        case MessageKind::Share:
+            reconciliation->OnShareDelivered(delivery.fromNode, toNode, delivery.share);
+            forNode.push_back(delivery);
+            break;
+        case MessageKind::GetShare:
+            reconciliation->OnShareRequested(delivery.fromNode, toNode);
+            forNode.push_back(delivery);
+            break;
+        default:
+            forNode.push_back(delivery);
+            break;
+        }
+    }
+    if (!forNode.empty())
+    {
+        receiver(toNode, forNode);
+    }
+    reconciliation->ClearRequests();
+}
+
+void AbstractNetwork::SetPayload(uint32_t payloadSize, uint32_t chunkSize, bool cutThroughRelay)
+{
+    payloadBytes = payloadSize;
+    chunkBytes = chunkSize > 0 && chunkSize < payloadSize ? chunkSize : payloadSize;
+    chunkCount = chunkBytes > 0 ? (payloadBytes + chunkBytes - 1) / chunkBytes : 1;
+    cutThrough = cutThroughRelay && chunkCount > 1;
+}
+
+uint32_t AbstractNetwork::GetChunkCount() const
+{
+    return chunkCount;
+}
+
+uint32_t AbstractNetwork::GetPacketCount() const
+{
+    return coded ? chunkCount + CODED_SPARE_PACKETS : chunkCount;
+}
+
+uint32_t AbstractNetwork::GetChunkBytes(uint32_t chunk) const
+{
+    if (coded)
+    {
+        // Combinations span whole chunks; the short last chunk is zero-padded
+        return chunkBytes + chunkCount;
+    }
+    return chunk + 1 < chunkCount ? chunkBytes : payloadBytes - chunk * chunkBytes;
+}
+
+bool AbstractNetwork::IsCutThrough() const
+{
+    return cutThrough;
+}
+
+void AbstractNetwork::SetNetworkCoding(Gf256Kernel kernel, uint64_t seed)
+{
+    coded = true;
+    codingKernel = kernel;
+    codingRng.Seed(seed, 0xc0de);
+}
+
+bool AbstractNetwork::IsCoded() const
+{
+    return coded;
+}
+
+Gf256Kernel AbstractNetwork::GetCodingKernel() const
+{
+    return codingKernel;
+}
+
+uint32_t AbstractNetwork::EncodeChunk(const RlncDecoder* decoder)
+{
+    uint32_t packet;
+    if (!freePackets.empty())
+    {
+        packet = freePackets.back();
+        freePackets.pop_back();
+    }
+    else
+    {
+        packet = static_cast<uint32_t>(codedPackets.size() / chunkCount);
+        codedPackets.resize(codedPackets.size() + chunkCount);
+    }
+    uint8_t* coefficients = &codedPackets[static_cast<size_t>(packet) * chunkCount];
+    if (decoder)
+    {
+        decoder->Combine(codingRng, coefficients);
+    }
+    else
+    {
+        RlncDecoder::RandomCoefficients(codingRng, chunkCount, coefficients);
+    }
+    return packet;
+}
+
+const uint8_t* AbstractNetwork::GetCodedPacket(uint32_t packet) const
+{
+    return &codedPackets[static_cast<size_t>(packet) * chunkCount];
+}
+
+void AbstractNetwork::ReleaseCodedPacket(uint32_t packet, bool innovative, bool decoded)
+{
+    freePackets.push_back(packet);
+    coding.packets++;
+    coding.innovative += innovative;
+    coding.decoded += decoded;
+}
+
+const AbstractNetwork::CodingStats& AbstractNetwork::GetCodingStats() const
+{
+    return coding;
+}
+
+Time AbstractNetwork::GetUplinkBacklog(uint32_t node) const
+{
+    if (accessLinks.empty())
+    {
+        return Time();
+    }
+    const AccessLink& link = accessLinks[node];
+    if (scheduler)
+    {
+        // Token buckets can hold the queue back longer; callers check again
+        Time backlog = link.uplink.CalculateBytesTxTime(
+            static_cast<uint32_t>(scheduler->GetQueuedBytes(node)));
+        return link.transmitting ? backlog + Simulator::GetDelayLeft(link.transmission)
+                                 : backlog;
+    }
+    Time backlog = link.uplinkFreeAt - Simulator::Now();
+    return backlog.IsStrictlyPositive() ? backlog : Time();
+}
+
+void AbstractNetwork::SetCompactRelay(uint32_t componentCount, double overlap)
+{
+    components = componentCount;
+    poolOverlap = overlap;
+}
+
+bool AbstractNetwork::IsCompact() const
+{
+    return components > 0;
+}
+
+uint32_t AbstractNetwork::GetCompactBodyBytes(MessageKind kind, uint32_t count) const
+{
+    switch (kind)
+    {
+    case MessageKind::CompactShare:
+        return components * SHORT_ID_BYTES;
+    case MessageKind::GetComponents:
+        return count * COMPONENT_INDEX_BYTES;
+    case MessageKind::Components:
+        return static_cast<uint32_t>(static_cast<uint64_t>(payloadBytes) * count / components);
+    default:
+        return 0;
+    }
+}
+
+// Maps a (share, component, node) triple to a uniform value in [0, 1) (SplitMix64 finalizer)
+static double ComponentHash(const Share& share, uint32_t component, uint32_t node)
+{
+    uint64_t x = (static_cast<uint64_t>(share.originNodeId) << 32 | share.shareId) ^
+                 (static_cast<uint64_t>(component) * 0x9E3779B97F4A7C15ull) ^
+                 (static_cast<uint64_t>(node) * 0xC2B2AE3D27D4EB4Full);
+    x = (x ^ (x >> 30)) * 0xBF58476D1CE4E5B9ull;
+    x = (x ^ (x >> 27)) * 0x94D049BB133111EBull;
+    x ^= x >> 31;
+    return (x >> 11) * 0x1.0p-53;
+}
+
+uint32_t AbstractNetwork::ReconstructShare(uint32_t node, const Share& share)
+{
+    uint32_t missing = 0;
+    for (uint32_t i = 0; i < components; i++)
+    {
+        if (ComponentHash(share, i, node) >= poolOverlap)
+        {
+            missing++;
+        }
+    }
+    compact.announcements++;
+    if (missing > 0)
+    {
+        compact.roundTrips++;
+        compact.componentsRequested += missing;
+    }
+    return missing;
+}
+
+const AbstractNetwork::CompactStats& AbstractNetwork::GetCompactStats() const
+{
+    return compact;
+}
+
+void AbstractNetwork::Reset(uint64_t seed)
+{
+    for (BatchMap* batches : {&pending, &downloading})
+    {
+        for (auto& entry : *batches)
+        {
+            Simulator::Cancel(entry.second.event);
+        }
+        batches->clear();
+    }
+    for (AccessLink& link : accessLinks)
+    {
+        Simulator::Cancel(link.transmission);
+        Simulator::Cancel(link.wakeup);
+        link = AccessLink{link.uplink, link.downlink, Time(), Time(), Time(), Time(), false,
+                          EventId(), EventId()};
+    }
+    if (scheduler)
+    {
+        scheduler->Reset();
+    }
+    uplinkWait = SampleStats();
+    downlinkWait = SampleStats();
+    deliveriesSent = 0;
+    eventsScheduled = 0;
+    bytesSent = 0;
+    compact = CompactStats();
+    // No coded packet is in flight any more, so every slot is free
+    codedPackets.clear();
+    freePackets.clear();
+    coding = CodingStats();
+    codingRng.Seed(seed, 0xc0de);
+}
+
+void AbstractNetwork::SetReconciliation(Reconciliation* setReconciliation)
+{
+    reconciliation = setReconciliation;
+}
+
+uint64_t AbstractNetwork::GetDeliveriesSent() const
+{
+    return deliveriesSent;
+}
+
+uint64_t AbstractNetwork::GetBytesSent() const
+{
+    return bytesSent;
+}
+
+uint64_t AbstractNetwork::GetEventsScheduled() const
+{
+    return eventsScheduled;
+}
+
+const SampleStats& AbstractNetwork::GetUplinkWait() const
+{
+    return uplinkWait;
+}
+
+const SampleStats& AbstractNetwork::GetDownlinkWait() const
+{
+    return downlinkWait;
+}
+
+Time AbstractNetwork::GetUplinkBusy(uint32_t node) const
+{
+    return accessLinks.empty() ? Time() : accessLinks[node].uplinkBusy;
+}
+
+Time AbstractNetwork::GetDownlinkBusy(uint32_t node) const
+{
+    return accessLinks.empty() ? Time() : accessLinks[node].downlinkBusy;
+}
@@ -0,0 +1,326 @@
+#ifndef ABSTRACT_NETWORK_H
+#define ABSTRACT_NETWORK_H
+
+#include "outboundscheduler.h"
+#include "p2ptypes.h"
+#include "pcgrandom.h"
+#include "rlnc.h"
+#include "statistics.h"
+
+#include <memory>
+#include <unordered_map>
+#include <vector>
+
+using namespace ns3;
+
+class Reconciliation;
+
+// Link layer that delivers shares by scheduling simulator events directly
+// instead of sending packets through the ns-3 TCP/IP stack. All deliveries
+// to the same node at the same simulated time are coalesced into a single
+// event carrying the whole batch, which keeps the event queue small when
+// many links share the same latency.
+//
+// Optionally every node has an access link: an uplink and a downlink of fixed
+// capacity shared by all of its peer links. A share is then serialized onto
+// the sender's uplink in FIFO order, crosses the link delay, and is
+// serialized again onto the receiver's downlink before it is delivered, so
+// nodes with many peers queue behind their own access capacity. With fair
+// queueing the uplink serves one queue per producer by deficit round robin
+// instead of a single FIFO (see OutboundScheduler).
+//
+// Shares can carry a payload. It is split into fixed-size chunks that travel
+// as separate deliveries, each with a copy of the share header; receiving
+// nodes reassemble them, relaying each new chunk at once with cut-through.
+//
+// With network coding the chunks travel as random linear combinations
+// instead; the coefficient vectors of packets in flight are kept here and a
+// delivery names one by its slot.
+//
+// With compact relay a share's payload is a list of components (like the
+// transactions of a block) that receivers mostly hold already. A share is
+// announced as its header and short IDs of the components; the receiver
+// rebuilds the payload from its pool and asks the sender for the components
+// it lacks, at the cost of a round trip. Whether a node holds a component is
+// a fixed pseudo-random draw with probability `poolOverlap`, standing in for
+// components that reached it ahead of the share.
+//
+// An attached Reconciliation takes over shares sent on reconciling links
+// and exchanges its own messages without the nodes seeing them.
+class AbstractNetwork
+{
+  public:
+    typedef Callback<void, uint32_t, const std::vector<Delivery>&> ReceiveCallback;
+
+    // Bytes per short component ID and per index of a requested component
+    static const uint32_t SHORT_ID_BYTES = 6;
+    static const uint32_t COMPONENT_INDEX_BYTES = 2;
+    // Coded packets a node sends each peer beyond the chunk count, so that a
+    // receiver whose packets were not all innovative still reaches full rank
+    static const uint32_t CODED_SPARE_PACKETS = 1;
+
+    // Compact relay counters over all nodes
+    struct CompactStats
+    {
+        uint64_t announcements = 0;       // compact shares received for the first time
+        uint64_t roundTrips = 0;          // announcements that needed a component request
+        uint64_t componentsRequested = 0;
+        uint64_t compactBytes = 0;        // announcements, requests and replies on the wire
+        uint64_t fullBytes = 0;           // the same announcements sent as full shares
+    };
+
+    // Network coding counters over all nodes
+    struct CodingStats
+    {
+        uint64_t packets = 0;    // coded packets received
+        uint64_t innovative = 0; // packets that raised the receiver's rank
+        uint64_t decoded = 0;    // shares a node decoded
+        uint64_t notices = 0;    // decoded notices sent to peers
+    };
+
+  private:
+    // Identifies the batch of deliveries to one node at one timestamp
+    struct BatchKey
+    {
+        int64_t timeStep;
+        uint32_t toNode;
+
+        bool operator==(const BatchKey& other) const
+        {
+            return timeStep == other.timeStep && toNode == other.toNode;
+        }
+    };
+
+    struct BatchKeyHash
+    {
+        size_t operator()(const BatchKey& key) const
+        {
+            return std::hash<int64_t>()(key.timeStep * 1000003 + key.toNode);
+        }
+    };
+
+    // Deliveries to one node at one timestamp and the event that hands them over
+    struct Batch
+    {
+        std::vector<Delivery> deliveries;
+        EventId event;
+    };
+
+    typedef std::unordered_map<BatchKey, Batch, BatchKeyHash> BatchMap;
+
+    // Shared access capacity of one node and the time its queues drain
+    struct AccessLink
+    {
+        DataRate uplink;
+        DataRate downlink;
+        Time uplinkFreeAt;
+        Time downlinkFreeAt;
+        Time uplinkBusy;
+        Time downlinkBusy;
+        // Fair queueing: a message is being serialized until `transmission`,
+        // and the pending retry of a uplink held back by empty token buckets
+        bool transmitting;
+        EventId transmission;
+        EventId wakeup;
+    };
+
+    ReceiveCallback receiver;
+    // Deliveries on their way to the destination (or its access router)
+    BatchMap pending;
+    // Deliveries being serialized onto the destination's downlink
+    BatchMap downloading;
+    // One entry per node, or empty when capacity is unlimited
+    std::vector<AccessLink> accessLinks;
+    SampleStats uplinkWait;
+    SampleStats downlinkWait;
+    uint64_t deliveriesSent;
+    uint64_t eventsScheduled;
+    uint64_t bytesSent;
+    uint32_t payloadBytes;
+    uint32_t chunkBytes;
+    uint32_t chunkCount;
+    bool cutThrough;
+    uint32_t components; // 0 sends full payloads
+    double poolOverlap;
+    CompactStats compact;
+    Reconciliation* reconciliation;
+    bool coded;
+    Gf256Kernel codingKernel;
+    Pcg32 codingRng;
+    // Coefficient vectors of coded packets in flight, chunkCount bytes per slot
+    std::vector<uint8_t> codedPackets;
+    std::vector<uint32_t> freePackets;
+    CodingStats coding;
+    std::unique_ptr<OutboundScheduler> scheduler; // null serves uplinks in FIFO order
+
+    // Adds a delivery to the batch reaching `toNode` after `delay`, scheduling
+    // `handler` for the batch when it is the first one
+    void Enqueue(BatchMap& batches,
+                 Time delay,
+                 uint32_t toNode,
+                 const Delivery& delivery,
+                 void (AbstractNetwork::*handler)(BatchKey));
+
+    // Removes and returns a batch whose time has come
+    static std::vector<Delivery> TakeBatch(BatchMap& batches, BatchKey key);
+
+    // Handles a batch arriving at its destination; with access links it is
+    // queued on the destination's downlink first
+    void DeliverBatch(BatchKey key);
+
+    // Hands a batch that finished crossing the downlink to its receiver
+    void CompleteDownload(BatchKey key);
+
+    // Starts serializing the node's next message from its scheduler unless the
+    // uplink is busy or every backlogged queue is out of tokens
+    void ServeUplink(uint32_t node);
+
+    // Sends a message that finished serializing onto the link and serves the next
+    void FinishUplink(uint32_t node, OutboundScheduler::Outgoing message);
+
+    // Passes reconciliation messages in a batch to the reconciliation and the
+    // rest to the receiving node
+    void Dispatch(uint32_t toNode, const std::vector<Delivery>& batch);
+
+  public:
+    AbstractNetwork();
+
+    // Registers the callback invoked with the destination node and each delivered batch
+    void SetReceiveCallback(ReceiveCallback callback);
+
+    // Gives the node an access link with the given capacities; once any node has
+    // one, every node that sends or receives must have one
+    void SetAccessLink(uint32_t node, DataRate uplink, DataRate downlink);
+
+    // Returns true if shares contend for per-node access capacity
+    bool HasAccessLinks() const;
+
+    // Serves every uplink by deficit round robin across producers, granting
+    // `quantumBytes` per turn, and caps each producer's queue with a token
+    // bucket of `rateBytesPerSecond` (0 = no cap) and `burstBytes`
+    void SetFairQueueing(uint32_t quantumBytes, double rateBytesPerSecond, uint32_t burstBytes);
+
+    // Returns the fair queueing counters, or nullptr with FIFO uplinks
+    const OutboundScheduler::Stats* GetFairQueueingStats() const;
+
+    // Delivers a message from one node to another after the given link delay,
+    // unless reconciliation takes over a share on this link; `bytes` is its
+    // size on the wire, which only matters with access links
+    void Send(MessageKind kind,
+              uint32_t fromNode,
+              uint32_t toNode,
+              const Share& share,
+              uint32_t value,
+              Time delay,
+              uint32_t bytes);
+
+    // Serializes a message onto the sender's uplink, if there is one, and
+    // delivers it after the link delay
+    void Transmit(MessageKind kind,
+                  uint32_t fromNode,
+                  uint32_t toNode,
+                  const Share& share,
+                  uint32_t value,
+                  Time delay,
+                  uint32_t bytes);
+
+    // Gives every share a payload split into chunks of `chunkSize` bytes (0 =
+    // one chunk), forwarded chunk by chunk when `cutThroughRelay` is set
+    void SetPayload(uint32_t payloadSize, uint32_t chunkSize, bool cutThroughRelay);
+
+    // Returns the number of chunks a share travels in (1 without chunking)
+    uint32_t GetChunkCount() const;
+
+    // Returns the number of messages a share's payload is sent in: its chunks,
+    // plus spare packets with network coding
+    uint32_t GetPacketCount() const;
+
+    // Returns the payload bytes carried by a chunk, plus its coefficient
+    // vector with network coding
+    uint32_t GetChunkBytes(uint32_t chunk) const;
+
+    // Returns true if nodes forward chunks as they arrive
+    bool IsCutThrough() const;
+
+    // Sends chunks as random linear combinations, with row operations done by
+    // `kernel` and coefficients drawn from a stream of `seed`
+    void SetNetworkCoding(Gf256Kernel kernel, uint64_t seed);
+
+    // Returns true if chunks travel as coded packets
+    bool IsCoded() const;
+
+    // Returns the kernel decoders of coded packets use
+    Gf256Kernel GetCodingKernel() const;
+
+    // Draws a fresh coded packet, a combination of the packets in `decoder`,
+    // or of all chunks if the sender has the whole share (nullptr); returns
+    // the packet's slot
+    uint32_t EncodeChunk(const RlncDecoder* decoder);
+
+    // Returns the coefficient vector of a coded packet in flight
+    const uint8_t* GetCodedPacket(uint32_t packet) const;
+
+    // Frees the slot of a delivered coded packet and counts whether it was
+    // innovative and completed a share at its receiver
+    void ReleaseCodedPacket(uint32_t packet, bool innovative, bool decoded);
+
+    // Returns the network coding counters
+    const CodingStats& GetCodingStats() const;
+
+    // Returns how long the node's uplink stays busy with the messages already
+    // handed to it (zero without access links); with fair queueing this is
+    // the rest of the current transmission plus the queued bytes at line rate
+    Time GetUplinkBacklog(uint32_t node) const;
+
+    // Announces share payloads as `componentCount` short IDs; a receiver
+    // holds each component with probability `overlap`
+    void SetCompactRelay(uint32_t componentCount, double overlap);
+
+    // Returns true if shares are relayed compactly
+    bool IsCompact() const;
+
+    // Returns the bytes a compact relay message adds to the share header;
+    // `count` is the number of components requested or sent
+    uint32_t GetCompactBodyBytes(MessageKind kind, uint32_t count) const;
+
+    // Rebuilds a newly announced share at a node from its pool; returns the
+    // number of components it has to request
+    uint32_t ReconstructShare(uint32_t node, const Share& share);
+
+    // Returns the compact relay counters
+    const CompactStats& GetCompactStats() const;
+
+    // Drops every message in flight or queued on an access link, clears all
+    // counters and link busy times and
+    // restarts the coding stream from a new seed (used between ensemble
+    // replications)
+    void Reset(uint64_t seed);
+
+    // Hands shares on reconciling links to the given reconciliation. Its state
+    // is per link, shared by both ends, so it stays with the reconciliation
+    // rather than the nodes; the network only routes messages to it
+    void SetReconciliation(Reconciliation* setReconciliation);
+
+    // Returns the number of messages handed to the network
+    uint64_t GetDeliveriesSent() const;
+
+    // Returns the bytes of all messages handed to the network
+    uint64_t GetBytesSent() const;
+
+    // Returns the number of delivery events scheduled (one per batch)
+    uint64_t GetEventsScheduled() const;
+
+    // Returns the time shares waited for a busy uplink before transmission, in seconds
+    const SampleStats& GetUplinkWait() const;
+
+    // Returns the time shares waited for a busy downlink before transmission, in seconds
+    const SampleStats& GetDownlinkWait() const;
+
+    // Returns the total time the node's uplink spent transmitting
+    Time GetUplinkBusy(uint32_t node) const;
+
+    // Returns the total time the node's downlink spent transmitting
+    Time GetDownlinkBusy(uint32_t node) const;
+};
+
+#endif
@@ -0,0 +1,114 @@
+#include "connectionbootstrap.h"
+
+#include <random>
+
+NS_LOG_COMPONENT_DEFINE("ConnectionBootstrap");
+
+ConnectionBootstrap::ConnectionBootstrap()
+    : nextConnection(0),
+      concurrency(0),
+      inFlight(0),
+      completed(0),
+      failed(0),
+      ready(false)
+{
+}
+
+void ConnectionBootstrap::SetOpenCallback(OpenCallback callback)
+{
+    opener = callback;
+}
+
+void ConnectionBootstrap::SetReadyCallback(ReadyCallback callback)
+{
+    onReady = callback;
+}
+
+void ConnectionBootstrap::AddConnection(uint32_t from, uint32_t to)
+{
+    connections.emplace_back(from, to);
+}
+
+void ConnectionBootstrap::Start(uint32_t maxConcurrent, Time jitter, uint64_t seed)
+{
+    concurrency = maxConcurrent;
+    maxJitter = jitter;
+    rng.Seed(seed, 0xb007);
+    startedAt = Simulator::Now();
+    NS_LOG_INFO("Opening " << connections.size() << " connections, "
+                           << (concurrency > 0 ? std::to_string(concurrency) : "unlimited")
+                           << " at a time with up to " << maxJitter.GetMilliSeconds()
+                           << " ms jitter");
+    FillSlots();
+    // An empty overlay is ready at once
+    CheckReady();
+}
+
+void ConnectionBootstrap::FillSlots()
+{
+    while (nextConnection < connections.size() && (concurrency == 0 || inFlight < concurrency))
+    {
+        const auto& connection = connections[nextConnection++];
+        inFlight++;
+        Time delay;
+        if (maxJitter.IsStrictlyPositive())
+        {
+            std::uniform_int_distribution<int64_t> dist(0, maxJitter.GetTimeStep());
+            delay = TimeStep(dist(rng));
+        }
+        Simulator::Schedule(delay,
+                            &ConnectionBootstrap::OpenConnection,
+                            this,
+                            connection.first,
+                            connection.second);
+    }
+}
+
+void ConnectionBootstrap::OpenConnection(uint32_t from, uint32_t to)
+{
+    opener(from, to);
+}
+
+void ConnectionBootstrap::NotifyDone(bool success)
+{
+    NS_ASSERT(inFlight > 0);
+    inFlight--;
+    completed++;
+    if (!success)
+    {
+        failed++;
+    }
+    FillSlots();
+    CheckReady();
+}
+
+void ConnectionBootstrap::CheckReady()
+{
+    if (!ready && completed == connections.size())
+    {
+        ready = true;
+        readyAt = Simulator::Now();
+        NS_LOG_INFO("Overlay ready after " << GetDuration().GetSeconds() << "s, " << failed
+                                           << " of " << connections.size()
+                                           << " connections failed");
+        if (!onReady.IsNull())
+        {
+            onReady();
+        }
+    }
+}
+
+bool ConnectionBootstrap::IsReady() const
+{
+    return ready;
+}
+
+Time ConnectionBootstrap::GetDuration() const
+{
+    return readyAt - startedAt;
+}
+
+uint32_t ConnectionBootstrap::GetFailedCount() const
+{
+    return failed;
+}
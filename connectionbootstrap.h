@@ -0,0 +1,74 @@
+#ifndef CONNECTION_BOOTSTRAP_H
+#define CONNECTION_BOOTSTRAP_H
+
+#include "pcgrandom.h"
+#include "p2ptypes.h"
+
+#include <utility>
+#include <vector>
+
+using namespace ns3;
+
+// Opens the overlay connections gradually instead of all at one instant: at
+// most `concurrency` handshakes are in flight, and each one starts after a
+// random jitter once a slot frees up. When every connection has completed or
+// failed, the ready callback fires once, acting as a barrier for share
+// generation.
+class ConnectionBootstrap
+{
+  public:
+    typedef Callback<void, uint32_t, uint32_t> OpenCallback;
+    typedef Callback<void> ReadyCallback;
+
+  private:
+    OpenCallback opener;
+    ReadyCallback onReady;
+    std::vector<std::pair<uint32_t, uint32_t>> connections;
+    size_t nextConnection;
+    uint32_t concurrency;
+    Time maxJitter;
+    Pcg32 rng;
+    uint32_t inFlight;
+    uint32_t completed;
+    uint32_t failed;
+    Time startedAt;
+    Time readyAt;
+    bool ready;
+
+    // Starts connections until the concurrency limit is reached
+    void FillSlots();
+
+    // Hands one connection to the opener after its jitter has elapsed
+    void OpenConnection(uint32_t from, uint32_t to);
+
+    // Fires the ready callback once the last connection has finished
+    void CheckReady();
+
+  public:
+    ConnectionBootstrap();
+
+    // Registers the callback that opens the connection from one node to another
+    void SetOpenCallback(OpenCallback callback);
+
+    // Registers the callback invoked once every connection has completed or failed
+    void SetReadyCallback(ReadyCallback callback);
+
+    // Queues a connection to open, in order
+    void AddConnection(uint32_t from, uint32_t to);
+
+    // Starts opening the queued connections now; a concurrency of 0 opens them all at once
+    void Start(uint32_t maxConcurrent, Time jitter, uint64_t seed);
+
+    // Reports that a connection handed to the opener has finished its handshake
+    void NotifyDone(bool success);
+
+    bool IsReady() const;
+
+    // Returns the time from Start until the last connection finished
+    Time GetDuration() const;
+
+    // Returns the number of connections whose handshake failed
+    uint32_t GetFailedCount() const;
+};
+
+#endif
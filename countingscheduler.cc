@@ -0,0 +1,89 @@
+#include "countingscheduler.h"
+
+NS_LOG_COMPONENT_DEFINE("CountingScheduler");
+
+NS_OBJECT_ENSURE_REGISTERED(CountingScheduler);
+
+uint64_t CountingScheduler::peakSize = 0;
+uint64_t CountingScheduler::totalInserts = 0;
+
+TypeId CountingScheduler::GetTypeId()
+{
+    static TypeId tid =
+        TypeId("CountingScheduler")
+            .SetParent<Scheduler>()
+            .AddConstructor<CountingScheduler>()
+            .AddAttribute("InnerType",
+                          "Scheduler implementation the events are delegated to",
+                          TypeIdValue(MapScheduler::GetTypeId()),
+                          MakeTypeIdAccessor(&CountingScheduler::SetInnerType),
+                          MakeTypeIdChecker());
+    return tid;
+}
+
+CountingScheduler::CountingScheduler()
+    : size(0)
+{
+}
+
+CountingScheduler::~CountingScheduler()
+{
+}
+
+void CountingScheduler::SetInnerType(TypeId tid)
+{
+    NS_ASSERT_MSG(!inner || inner->IsEmpty(), "Cannot replace a non-empty delegate scheduler");
+    ObjectFactory factory;
+    factory.SetTypeId(tid);
+    inner = factory.Create<Scheduler>();
+    NS_LOG_INFO("Delegating events to " << tid.GetName());
+}
+
+void CountingScheduler::Insert(const Event& ev)
+{
+    inner->Insert(ev);
+    size++;
+    totalInserts++;
+    if (size > peakSize)
+    {
+        peakSize = size;
+    }
+}
+
+bool CountingScheduler::IsEmpty() const
+{
+    return inner->IsEmpty();
+}
+
+Scheduler::Event CountingScheduler::PeekNext() const
+{
+    return inner->PeekNext();
+}
+
+Scheduler::Event CountingScheduler::RemoveNext()
+{
+    size--;
+    return inner->RemoveNext();
+}
+
+void CountingScheduler::Remove(const Event& ev)
+{
+    size--;
+    inner->Remove(ev);
+}
+
+uint64_t CountingScheduler::GetPeakSize()
+{
+    return peakSize;
+}
+
+uint64_t CountingScheduler::GetTotalInserts()
+{
+    return totalInserts;
+}
+
+void CountingScheduler::ResetCounters()
+{
+    peakSize = 0;
+    totalInserts = 0;
+}
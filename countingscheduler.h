@@ -0,0 +1,45 @@
+#ifndef COUNTING_SCHEDULER_H
+#define COUNTING_SCHEDULER_H
+
+#include "ns3/core-module.h"
+
+using namespace ns3;
+
+// Scheduler decorator that delegates to another ns-3 scheduler implementation
+// and keeps track of the event queue size, so benchmark runs can report the
+// peak number of pending events for each backend.
+class CountingScheduler : public Scheduler
+{
+  private:
+    Ptr<Scheduler> inner;
+    uint64_t size;
+
+    static uint64_t peakSize;
+    static uint64_t totalInserts;
+
+    // Creates the delegate scheduler from its TypeId
+    void SetInnerType(TypeId tid);
+
+  public:
+    static TypeId GetTypeId();
+
+    CountingScheduler();
+    ~CountingScheduler() override;
+
+    void Insert(const Event& ev) override;
+    bool IsEmpty() const override;
+    Event PeekNext() const override;
+    Event RemoveNext() override;
+    void Remove(const Event& ev) override;
+
+    // Returns the largest queue size seen since the last reset
+    static uint64_t GetPeakSize();
+
+    // Returns the number of events inserted since the last reset
+    static uint64_t GetTotalInserts();
+
+    // Clears the peak and insert counters before a new run
+    static void ResetCounters();
+};
+
+#endif
@@ -0,0 +1,4 @@
+#include "generationdriver.h"
+
+// ShareGenerationDriver is a class template; its log component is defined here
+NS_LOG_COMPONENT_DEFINE("ShareGenerationDriver");
@@ -0,0 +1,221 @@
+#ifndef GENERATION_DRIVER_H
+#define GENERATION_DRIVER_H
+
+#include "hashrate.h"
+#include "pcgrandom.h"
+
+#include "ns3/core-module.h"
+
+#include <algorithm>
+#include <random>
+#include <vector>
+
+using namespace ns3;
+
+// Drives share generation for all nodes from a single pending simulator event.
+// Each node's next generation time is kept in a binary min-heap and only the
+// earliest deadline is scheduled in the ns-3 event queue, so the queue holds
+// O(1) generation events instead of one per node.
+//
+// With per-node share rates (hashrate-weighted mining) generation is instead
+// one merged Poisson process: the next share comes after an exponential gap at
+// the total rate and its origin is drawn in O(1) from an alias table weighted
+// by rate, which is equivalent to independent per-node Poisson processes.
+template <typename NodeT>
+class ShareGenerationDriver
+{
+  private:
+    // Heap entry: next generation time of one node
+    struct Deadline
+    {
+        Time when;
+        uint32_t slot;
+    };
+
+    NS_LOG_TEMPLATE_DECLARE;
+    std::vector<NodeT*> nodes;
+    std::vector<Deadline> deadlines;
+    EventId nextEvent;
+    bool running;
+    AliasTable originTable;
+    double totalRate;
+    Pcg32 rng;
+
+    // Orders the heap so the earliest deadline (lowest slot on ties) is on top
+    static bool Later(const Deadline& a, const Deadline& b);
+
+    // Schedules the single simulator event for the earliest deadline
+    void ScheduleHead();
+
+    // Generates shares for all nodes whose deadline has been reached
+    void Fire();
+
+    // Schedules the next share of the merged Poisson process
+    void ScheduleMerged();
+
+    // Generates one share at a node drawn by rate, then schedules the next
+    void FireMerged();
+
+  public:
+    ShareGenerationDriver();
+
+    // Registers a node whose shares are generated by this driver
+    void AddNode(NodeT* node);
+
+    // Switches to merged Poisson generation with the given shares per second
+    // of each registered node, in registration order, drawing from `seed`
+    void SetShareRates(const std::vector<double>& rates, uint64_t seed);
+
+    // Restarts the merged process's random stream from a new seed
+    void Reseed(uint64_t seed);
+
+    // Enables generation on all registered nodes and draws their first deadlines
+    void Start();
+
+    // Stops generating shares and cancels the pending event
+    void Stop();
+
+    // Returns the number of nodes with a pending deadline
+    size_t GetPendingCount() const;
+};
+
+template <typename NodeT>
+ShareGenerationDriver<NodeT>::ShareGenerationDriver()
+    : NS_LOG_TEMPLATE_DEFINE("ShareGenerationDriver"),
+      running(false),
+      totalRate(0.0)
+{
+}
+
+template <typename NodeT>
+bool ShareGenerationDriver<NodeT>::Later(const Deadline& a, const Deadline& b)
+{
+    if (a.when != b.when)
+    {
+        return a.when > b.when;
+    }
+    return a.slot > b.slot;
+}
+
+template <typename NodeT>
+void ShareGenerationDriver<NodeT>::AddNode(NodeT* node)
+{
+    nodes.push_back(node);
+}
+
+template <typename NodeT>
+void ShareGenerationDriver<NodeT>::SetShareRates(const std::vector<double>& rates, uint64_t seed)
+{
+    originTable = AliasTable(rates);
+    totalRate = 0.0;
+    for (double rate : rates)
+    {
+        totalRate += rate;
+    }
+    Reseed(seed);
+}
+
+template <typename NodeT>
+void ShareGenerationDriver<NodeT>::Reseed(uint64_t seed)
+{
+    rng.Seed(seed, 0x9e4);
+}
+
+template <typename NodeT>
+void ShareGenerationDriver<NodeT>::Start()
+{
+    running = true;
+    deadlines.clear();
+    if (!originTable.IsEmpty())
+    {
+        for (NodeT* node : nodes)
+        {
+            node->EnableShareGeneration();
+        }
+        NS_LOG_INFO("Driving share generation for " << nodes.size()
+                                                    << " nodes as one Poisson process at "
+                                                    << totalRate << " shares/s");
+        ScheduleMerged();
+        return;
+    }
+    deadlines.reserve(nodes.size());
+
+    Time now = Simulator::Now();
+    for (uint32_t slot = 0; slot < nodes.size(); slot++)
+    {
+        nodes[slot]->EnableShareGeneration();
+        deadlines.push_back(Deadline{now + nodes[slot]->DrawShareInterval(), slot});
+    }
+    std::make_heap(deadlines.begin(), deadlines.end(), Later);
+
+    NS_LOG_INFO("Driving share generation for " << nodes.size() << " nodes");
+    ScheduleHead();
+}
+
+template <typename NodeT>
+void ShareGenerationDriver<NodeT>::Stop()
+{
+    running = false;
+    nextEvent.Cancel();
+    deadlines.clear();
+}
+
+template <typename NodeT>
+void ShareGenerationDriver<NodeT>::ScheduleHead()
+{
+    if (!running || deadlines.empty())
+    {
+        return;
+    }
+    nextEvent = Simulator::Schedule(deadlines.front().when - Simulator::Now(),
+                                    &ShareGenerationDriver::Fire,
+                                    this);
+}
+
+template <typename NodeT>
+void ShareGenerationDriver<NodeT>::Fire()
+{
+    Time now = Simulator::Now();
+    while (running && !deadlines.empty() && deadlines.front().when <= now)
+    {
+        std::pop_heap(deadlines.begin(), deadlines.end(), Later);
+        Deadline& due = deadlines.back();
+        NodeT* node = nodes[due.slot];
+
+        node->GenerateShare();
+
+        due.when = now + node->DrawShareInterval();
+        std::push_heap(deadlines.begin(), deadlines.end(), Later);
+    }
+    ScheduleHead();
+}
+
+template <typename NodeT>
+void ShareGenerationDriver<NodeT>::ScheduleMerged()
+{
+    std::exponential_distribution<double> gap(totalRate);
+    nextEvent = Simulator::Schedule(Seconds(gap(rng)), &ShareGenerationDriver::FireMerged, this);
+}
+
+template <typename NodeT>
+void ShareGenerationDriver<NodeT>::FireMerged()
+{
+    if (!running)
+    {
+        return;
+    }
+    nodes[originTable.Sample(rng)]->GenerateShare();
+    ScheduleMerged();
+}
+
+template <typename NodeT>
+size_t ShareGenerationDriver<NodeT>::GetPendingCount() const
+{
+    if (!originTable.IsEmpty())
+    {
+        return running ? nodes.size() : 0;
+    }
+    return deadlines.size();
+}
+
+#endif
@@ -0,0 +1,239 @@
+#include "gf256.h"
+
+// The vector kernels split every byte into its low and high nibble and look
+// up c * nibble in two 16-entry tables with PSHUFB; the two products XOR to
+// c * byte. The entry points carry target attributes, so no special build
+// flags are needed and they only run if the CPU reports support.
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#define GF256_X86 1
+#include <immintrin.h>
+#endif
+
+// Full product table and inverses, built once on first use
+struct Gf256Tables
+{
+    uint8_t mul[256][256];
+    uint8_t inverse[256];
+
+    Gf256Tables()
+    {
+        uint8_t exp[255];
+        uint8_t log[256] = {};
+        uint32_t x = 1;
+        for (uint32_t i = 0; i < 255; i++)
+        {
+            exp[i] = static_cast<uint8_t>(x);
+            log[x] = static_cast<uint8_t>(i);
+            x <<= 1;
+            if (x & 0x100)
+            {
+                x ^= 0x11d;
+            }
+        }
+        for (uint32_t a = 0; a < 256; a++)
+        {
+            for (uint32_t b = 0; b < 256; b++)
+            {
+                mul[a][b] = a == 0 || b == 0 ? 0 : exp[(log[a] + log[b]) % 255];
+            }
+            inverse[a] = a == 0 ? 0 : exp[(255 - log[a]) % 255];
+        }
+    }
+};
+
+static const Gf256Tables& Tables()
+{
+    static const Gf256Tables tables;
+    return tables;
+}
+
+uint8_t Gf256Mul(uint8_t a, uint8_t b)
+{
+    return Tables().mul[a][b];
+}
+
+uint8_t Gf256Inverse(uint8_t a)
+{
+    return Tables().inverse[a];
+}
+
+// dst = c * src, or dst ^= c * src when accumulating
+static void Gf256RowScalar(uint8_t* dst, const uint8_t* src, uint8_t c, size_t length, bool add)
+{
+    const uint8_t* row = Tables().mul[c];
+    for (size_t i = 0; i < length; i++)
+    {
+        dst[i] = add ? dst[i] ^ row[src[i]] : row[src[i]];
+    }
+}
+
+#ifdef GF256_X86
+__attribute__((target("ssse3"))) static size_t Gf256RowSsse3(uint8_t* dst,
+                                                             const uint8_t* src,
+                                                             uint8_t c,
+                                                             size_t length,
+                                                             bool add)
+{
+    const uint8_t* row = Tables().mul[c];
+    alignas(16) uint8_t low[16];
+    alignas(16) uint8_t high[16];
+    for (int i = 0; i < 16; i++)
+    {
+        low[i] = row[i];
+        high[i] = row[i << 4];
+    }
+    __m128i lowTable = _mm_load_si128(reinterpret_cast<const __m128i*>(low));
+    __m128i highTable = _mm_load_si128(reinterpret_cast<const __m128i*>(high));
+    __m128i mask = _mm_set1_epi8(0x0f);
+    size_t i = 0;
+    for (; i + 16 <= length; i += 16)
+    {
+        __m128i in = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + i));
+        __m128i product =
+            _mm_xor_si128(_mm_shuffle_epi8(lowTable, _mm_and_si128(in, mask)),
+                          _mm_shuffle_epi8(highTable, _mm_and_si128(_mm_srli_epi64(in, 4), mask)));
+        if (add)
+        {
+            product =
+                _mm_xor_si128(product, _mm_loadu_si128(reinterpret_cast<const __m128i*>(dst + i)));
+        }
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(dst + i), product);
+    }
+    return i;
+}
+
+__attribute__((target("avx2"))) static size_t Gf256RowAvx2(uint8_t* dst,
+                                                           const uint8_t* src,
+                                                           uint8_t c,
+                                                           size_t length,
+                                                           bool add)
+{
+    const uint8_t* row = Tables().mul[c];
+    alignas(16) uint8_t low[16];
+    alignas(16) uint8_t high[16];
+    for (int i = 0; i < 16; i++)
+    {
+        low[i] = row[i];
+        high[i] = row[i << 4];
+    }
+    // VPSHUFB shuffles within 128-bit lanes, so both lanes get the tables
+    __m256i lowTable =
+        _mm256_broadcastsi128_si256(_mm_load_si128(reinterpret_cast<const __m128i*>(low)));
+    __m256i highTable =
+        _mm256_broadcastsi128_si256(_mm_load_si128(reinterpret_cast<const __m128i*>(high)));
+    __m256i mask = _mm256_set1_epi8(0x0f);
+    size_t i = 0;
+    for (; i + 32 <= length; i += 32)
+    {
+        __m256i in = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(src + i));
+        __m256i product = _mm256_xor_si256(
+            _mm256_shuffle_epi8(lowTable, _mm256_and_si256(in, mask)),
+            _mm256_shuffle_epi8(highTable, _mm256_and_si256(_mm256_srli_epi64(in, 4), mask)));
+        if (add)
+        {
+            product = _mm256_xor_si256(
+                product, _mm256_loadu_si256(reinterpret_cast<const __m256i*>(dst + i)));
+        }
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(dst + i), product);
+    }
+    return i;
+}
+#endif
+
+bool Gf256KernelSupported(Gf256Kernel kernel)
+{
+    switch (kernel)
+    {
+    case Gf256Kernel::Scalar:
+        return true;
+#ifdef GF256_X86
+    case Gf256Kernel::Ssse3:
+        return __builtin_cpu_supports("ssse3");
+    case Gf256Kernel::Avx2:
+        return __builtin_cpu_supports("avx2");
+#endif
+    default:
+        return false;
+    }
+}
+
+Gf256Kernel Gf256BestKernel()
+{
+    for (Gf256Kernel kernel : {Gf256Kernel::Avx2, Gf256Kernel::Ssse3})
+    {
+        if (Gf256KernelSupported(kernel))
+        {
+            return kernel;
+        }
+    }
+    return Gf256Kernel::Scalar;
+}
+
+bool Gf256KernelFromName(const std::string& name, Gf256Kernel& kernel)
+{
+    if (name == "auto")
+    {
+        kernel = Gf256BestKernel();
+        return true;
+    }
+    for (Gf256Kernel candidate : {Gf256Kernel::Scalar, Gf256Kernel::Ssse3, Gf256Kernel::Avx2})
+    {
+        if (name == Gf256KernelName(candidate))
+        {
+            kernel = candidate;
+            return true;
+        }
+    }
+    return false;
+}
+
+const char* Gf256KernelName(Gf256Kernel kernel)
+{
+    switch (kernel)
+    {
+    case Gf256Kernel::Ssse3:
+        return "ssse3";
+    case Gf256Kernel::Avx2:
+        return "avx2";
+    default:
+        return "scalar";
+    }
+}
+
+// Runs the kernel over full vectors and the scalar code over the remainder
+static void Gf256Row(Gf256Kernel kernel,
+                     uint8_t* dst,
+                     const uint8_t* src,
+                     uint8_t c,
+                     size_t length,
+                     bool add)
+{
+    size_t done = 0;
+#ifdef GF256_X86
+    if (kernel == Gf256Kernel::Avx2)
+    {
+        done = Gf256RowAvx2(dst, src, c, length, add);
+    }
+    else if (kernel == Gf256Kernel::Ssse3)
+    {
+        done = Gf256RowSsse3(dst, src, c, length, add);
+    }
+#endif
+    Gf256RowScalar(dst + done, src + done, c, length - done, add);
+}
+
+void Gf256MulAdd(Gf256Kernel kernel, uint8_t* dst, const uint8_t* src, uint8_t c, size_t length)
+{
+    if (c != 0)
+    {
+        Gf256Row(kernel, dst, src, c, length, true);
+    }
+}
+
+void Gf256Scale(Gf256Kernel kernel, uint8_t* dst, uint8_t c, size_t length)
+{
+    if (c != 1)
+    {
+        Gf256Row(kernel, dst, dst, c, length, false);
+    }
+}
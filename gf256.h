@@ -0,0 +1,46 @@
+#ifndef GF256_H
+#define GF256_H
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+// Arithmetic in GF(2^8) with the polynomial x^8 + x^4 + x^3 + x^2 + 1 (0x11d),
+// the field random linear network coding works over. Addition is XOR; the
+// bulk operation is a multiply-add of a whole row by one constant, which has
+// a scalar kernel on a 64 KB product table and SSSE3 and AVX2 kernels that
+// look up the products of the low and high nibbles with byte shuffles, 16 or
+// 32 bytes at a time. The kernel is picked at run time like the SHA-256 ones.
+
+enum class Gf256Kernel
+{
+    Scalar,
+    Ssse3,
+    Avx2
+};
+
+// Returns the widest kernel the CPU supports
+Gf256Kernel Gf256BestKernel();
+
+// Returns true if the CPU can run the kernel
+bool Gf256KernelSupported(Gf256Kernel kernel);
+
+// Parses scalar, ssse3, avx2 or auto (the best supported); returns false for other names
+bool Gf256KernelFromName(const std::string& name, Gf256Kernel& kernel);
+
+// Returns the kernel's name as accepted by Gf256KernelFromName
+const char* Gf256KernelName(Gf256Kernel kernel);
+
+// Returns the product of two field elements
+uint8_t Gf256Mul(uint8_t a, uint8_t b);
+
+// Returns the multiplicative inverse of a non-zero element
+uint8_t Gf256Inverse(uint8_t a);
+
+// dst[i] ^= c * src[i] for `length` bytes
+void Gf256MulAdd(Gf256Kernel kernel, uint8_t* dst, const uint8_t* src, uint8_t c, size_t length);
+
+// dst[i] = c * dst[i] for `length` bytes
+void Gf256Scale(Gf256Kernel kernel, uint8_t* dst, uint8_t c, size_t length);
+
+#endif
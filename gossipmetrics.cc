@@ -0,0 +1,165 @@
+#include "gossipmetrics.h"
+
+GossipMetrics::GossipMetrics(uint32_t numNodes)
+    : numNodes(numNodes),
+      sharesGenerated(0),
+      originLatency(numNodes)
+{
+}
+
+uint64_t GossipMetrics::Key(const Share& share)
+{
+    return (static_cast<uint64_t>(share.originNodeId) << 32) | share.shareId;
+}
+
+double GossipMetrics::Coverage(const ShareRecord& record) const
+{
+    return numNodes > 1 ? static_cast<double>(record.receivers) / (numNodes - 1) : 0.0;
+}
+
+void GossipMetrics::OnShareGenerated(const Share& share)
+{
+    shares[Key(share)] = ShareRecord{share.timestamp, 0};
+    creationOrder.push_back(Key(share));
+    sharesGenerated++;
+}
+
+void GossipMetrics::SetNodeClasses(const std::vector<uint32_t>& nodeClasses, uint32_t numClasses)
+{
+    classOf = nodeClasses;
+    classMetrics.assign(numClasses, ClassMetrics());
+}
+
+void GossipMetrics::OnShareReceived(const Share& share, uint32_t nodeId)
+{
+    // Receipts of finalized shares, or of shares from before a reset, are ignored
+    auto it = shares.find(Key(share));
+    if (it == shares.end())
+    {
+        return;
+    }
+    double delay = Simulator::Now().GetSeconds() - it->second.createdAt;
+    latency.Add(delay);
+    latencyHistogram.Add(delay);
+    batch.latency.Add(delay);
+    originLatency[share.originNodeId].Add(delay);
+    if (!classOf.empty())
+    {
+        ClassMetrics& receiverClass = classMetrics[classOf[nodeId]];
+        receiverClass.latency.Add(delay);
+        receiverClass.latencyHistogram.Add(delay);
+    }
+    it->second.receivers++;
+}
+
+void GossipMetrics::FinalizeShares(double horizon)
+{
+    double cutoff = Simulator::Now().GetSeconds() - horizon;
+    while (!creationOrder.empty())
+    {
+        auto it = shares.find(creationOrder.front());
+        if (it != shares.end())
+        {
+            if (it->second.createdAt > cutoff)
+            {
+                break;
+            }
+            double coverage = Coverage(it->second);
+            finalizedCoverage.Add(coverage);
+            batch.coverage.Add(coverage);
+            if (!classOf.empty())
+            {
+                classMetrics[classOf[it->first >> 32]].finalizedCoverage.Add(coverage);
+            }
+            shares.erase(it);
+        }
+        creationOrder.pop_front();
+    }
+}
+
+GossipMetrics::Batch GossipMetrics::TakeBatch()
+{
+    Batch taken = batch;
+    batch = Batch();
+    return taken;
+}
+
+void GossipMetrics::Reset()
+{
+    sharesGenerated = 0;
+    shares.clear();
+    creationOrder.clear();
+    latency.Reset();
+    latencyHistogram.Reset();
+    finalizedCoverage.Reset();
+    for (SampleStats& stats : originLatency)
+    {
+        stats.Reset();
+    }
+    for (ClassMetrics& metricsOfClass : classMetrics)
+    {
+        metricsOfClass = ClassMetrics();
+    }
+    batch = Batch();
+}
+
+uint64_t GossipMetrics::GetSharesGenerated() const
+{
+    return sharesGenerated;
+}
+
+const SampleStats& GossipMetrics::GetLatency() const
+{
+    return latency;
+}
+
+const SampleStats& GossipMetrics::GetOriginLatency(uint32_t nodeId) const
+{
+    return originLatency[nodeId];
+}
+
+const LogHistogram& GossipMetrics::GetLatencyHistogram() const
+{
+    return latencyHistogram;
+}
+
+double GossipMetrics::GetMeanCoverage() const
+{
+    uint64_t count = finalizedCoverage.GetCount() + shares.size();
+    if (count == 0)
+    {
+        return 0.0;
+    }
+    double total = finalizedCoverage.GetMean() * finalizedCoverage.GetCount();
+    for (const auto& entry : shares)
+    {
+        total += Coverage(entry.second);
+    }
+    return total / count;
+}
+
+const SampleStats& GossipMetrics::GetClassLatency(uint32_t nodeClass) const
+{
+    return classMetrics[nodeClass].latency;
+}
+
+const LogHistogram& GossipMetrics::GetClassLatencyHistogram(uint32_t nodeClass) const
+{
+    return classMetrics[nodeClass].latencyHistogram;
+}
+
+double GossipMetrics::GetClassMeanCoverage(uint32_t nodeClass) const
+{
+    const SampleStats& finalized = classMetrics[nodeClass].finalizedCoverage;
+    uint64_t count = finalized.GetCount();
+    double total = finalized.GetMean() * count;
+    for (const auto& entry : shares)
+    {
+        if (classOf[entry.first >> 32] == nodeClass)
+        {
+            total += Coverage(entry.second);
+            count++;
+        }
+    }
+    return count > 0 ? total / count : 0.0;
+}
@@ -0,0 +1,105 @@
+#ifndef GOSSIP_METRICS_H
+#define GOSSIP_METRICS_H
+
+#include "p2ptypes.h"
+#include "statistics.h"
+
+#include <deque>
+#include <unordered_map>
+
+using namespace ns3;
+
+// Collects network-wide propagation metrics: for every generated share, the
+// latency of each first receipt and how many nodes it reached.
+class GossipMetrics
+{
+  public:
+    // Observations accumulated since the previous batch was taken
+    struct Batch
+    {
+        SampleStats latency;
+        SampleStats coverage;
+    };
+
+  private:
+    // Per-share record, keyed by origin node and share id
+    struct ShareRecord
+    {
+        double createdAt;
+        uint32_t receivers;
+    };
+
+    // Metrics of one node class: latency as seen by its receivers and
+    // coverage of the shares its nodes originated
+    struct ClassMetrics
+    {
+        SampleStats latency;
+        LogHistogram latencyHistogram;
+        SampleStats finalizedCoverage;
+    };
+
+    uint32_t numNodes;
+    uint64_t sharesGenerated;
+    std::unordered_map<uint64_t, ShareRecord> shares;
+    std::deque<uint64_t> creationOrder;
+    SampleStats latency;
+    LogHistogram latencyHistogram;
+    SampleStats finalizedCoverage;
+    Batch batch;
+    // Class of every node, empty when the network has a single class
+    std::vector<uint32_t> classOf;
+    std::vector<ClassMetrics> classMetrics;
+    // Latency of the shares each node originated, over all their receivers
+    std::vector<SampleStats> originLatency;
+
+    static uint64_t Key(const Share& share);
+
+    // Returns the fraction of the other nodes the share reached
+    double Coverage(const ShareRecord& record) const;
+
+  public:
+    GossipMetrics(uint32_t numNodes);
+
+    // Records a share created at its origin
+    void OnShareGenerated(const Share& share);
+
+    // Breaks metrics down by node class from now on
+    void SetNodeClasses(const std::vector<uint32_t>& nodeClasses, uint32_t numClasses);
+
+    // Records the first receipt of a share at a node
+    void OnShareReceived(const Share& share, uint32_t nodeId);
+
+    // Fixes the coverage of shares created at least `horizon` seconds ago and
+    // stops tracking them; later receipts of those shares are not counted
+    void FinalizeShares(double horizon);
+
+    // Returns the observations since the previous call and starts a new batch
+    Batch TakeBatch();
+
+    // Forgets all shares and samples
+    void Reset();
+
+    // Returns the number of shares generated since the last reset
+    uint64_t GetSharesGenerated() const;
+
+    // Returns the first-receipt latency statistics in seconds
+    const SampleStats& GetLatency() const;
+
+    // Returns the distribution of first-receipt latencies in seconds, for percentiles
+    const LogHistogram& GetLatencyHistogram() const;
+
+    // Returns the mean fraction of the other nodes each share reached
+    double GetMeanCoverage() const;
+
+    // Returns the first-receipt latency at nodes of the class, in seconds
+    const SampleStats& GetClassLatency(uint32_t nodeClass) const;
+    const LogHistogram& GetClassLatencyHistogram(uint32_t nodeClass) const;
+
+    // Returns the first-receipt latency of the shares the node originated, in seconds
+    const SampleStats& GetOriginLatency(uint32_t nodeId) const;
+
+    // Returns the mean coverage of shares originated by nodes of the class
+    double GetClassMeanCoverage(uint32_t nodeClass) const;
+};
+
+#endif
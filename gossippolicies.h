@@ -0,0 +1,270 @@
+#ifndef GOSSIP_POLICIES_H
+#define GOSSIP_POLICIES_H
+
+#include "p2ptypes.h"
+
+#include <algorithm>
+#include <cstring>
+#include <unordered_set>
+
+// Policies plugged into BasicP2PNode. They are resolved at compile time so the
+// per-message path (dedup check, peer selection, encoding) is inlined into the
+// node; the combination used for a run is picked once in main().
+
+// ---- Dedup policies: remember which shares a node has already processed ----
+
+// Keeps processed share ids in a std::unordered_set
+class HashSetDedup
+{
+  private:
+    std::unordered_set<uint32_t> seen;
+
+  public:
+    // Records the share id, returns false if it was already present
+    bool Insert(uint32_t shareId)
+    {
+        return seen.insert(shareId).second;
+    }
+
+    // Returns true if the share id was recorded
+    bool Contains(uint32_t shareId) const
+    {
+        return seen.count(shareId) > 0;
+    }
+
+    size_t Size() const
+    {
+        return seen.size();
+    }
+
+    // Approximate heap usage: one list node per id plus the bucket array
+    size_t HeapBytes() const
+    {
+        return seen.size() * (sizeof(void*) + sizeof(uint32_t)) +
+               seen.bucket_count() * sizeof(void*);
+    }
+};
+
+// Keeps processed share ids in an open-addressing table with linear probing
+class FlatDedup
+{
+  private:
+    std::vector<uint32_t> slots; // 0 marks an empty slot
+    size_t count;
+    bool hasZero;
+
+    static size_t Hash(uint32_t shareId)
+    {
+        return static_cast<uint32_t>(shareId * 0x9E3779B1u);
+    }
+
+    void Grow()
+    {
+        std::vector<uint32_t> old;
+        old.swap(slots);
+        slots.assign(old.empty() ? 64 : old.size() * 2, 0);
+        for (uint32_t shareId : old)
+        {
+            if (shareId != 0)
+            {
+                Place(shareId);
+            }
+        }
+    }
+
+    bool Place(uint32_t shareId)
+    {
+        size_t mask = slots.size() - 1;
+        for (size_t i = Hash(shareId) & mask;; i = (i + 1) & mask)
+        {
+            if (slots[i] == shareId)
+            {
+                return false;
+            }
+            if (slots[i] == 0)
+            {
+                slots[i] = shareId;
+                return true;
+            }
+        }
+    }
+
+  public:
+    FlatDedup()
+        : count(0),
+          hasZero(false)
+    {
+    }
+
+    bool Insert(uint32_t shareId)
+    {
+        if (shareId == 0)
+        {
+            bool inserted = !hasZero;
+            hasZero = true;
+            count += inserted;
+            return inserted;
+        }
+        if ((count + 1) * 2 > slots.size())
+        {
+            Grow();
+        }
+        bool inserted = Place(shareId);
+        count += inserted;
+        return inserted;
+    }
+
+    bool Contains(uint32_t shareId) const
+    {
+        if (shareId == 0)
+        {
+            return hasZero;
+        }
+        if (slots.empty())
+        {
+            return false;
+        }
+        size_t mask = slots.size() - 1;
+        for (size_t i = Hash(shareId) & mask;; i = (i + 1) & mask)
+        {
+            if (slots[i] == shareId)
+            {
+                return true;
+            }
+            if (slots[i] == 0)
+            {
+                return false;
+            }
+        }
+    }
+
+    size_t Size() const
+    {
+        return count;
+    }
+
+    size_t HeapBytes() const
+    {
+        return slots.capacity() * sizeof(uint32_t);
+    }
+};
+
+// ---- Forward policies: choose the peer table slots a share is sent to ----
+
+// Sends the share to every peer, including the one it came from
+struct FloodForward
+{
+    template <typename Emit>
+    static void Select(const std::vector<PeerEntry>& peers, uint32_t /*fromSlot*/, Emit&& emit)
+    {
+        for (uint32_t slot = 0; slot < peers.size(); slot++)
+        {
+            emit(slot);
+        }
+    }
+};
+
+// Sends the share to every peer except the one it came from
+struct SkipSenderForward
+{
+    template <typename Emit>
+    static void Select(const std::vector<PeerEntry>& peers, uint32_t fromSlot, Emit&& emit)
+    {
+        for (uint32_t slot = 0; slot < peers.size(); slot++)
+        {
+            if (slot != fromSlot)
+            {
+                emit(slot);
+            }
+        }
+    }
+};
+
+// Kadcast delegated broadcast (Rohrer and Tschorsch, 2019): a share received
+// from a peer in bucket h is sent to one peer in each lower bucket, and a new
+// share to one peer in every bucket. Each node is responsible for the subtree
+// below the bucket it was reached through, so with non-empty buckets every
+// node receives a share once, over O(N) messages and O(log N) hops. The first
+// connected peer of a bucket is used.
+struct KadcastForward
+{
+    template <typename Emit>
+    static void Select(const std::vector<PeerEntry>& peers, uint32_t fromSlot, Emit&& emit)
+    {
+        uint8_t height = fromSlot < peers.size() ? peers[fromSlot].bucket : KADCAST_BUCKETS;
+        uint32_t chosen[KADCAST_BUCKETS];
+        std::fill(chosen, chosen + KADCAST_BUCKETS, NO_PEER_SLOT);
+        for (uint32_t slot = 0; slot < peers.size(); slot++)
+        {
+            const PeerEntry& peer = peers[slot];
+            if (peer.bucket < height && chosen[peer.bucket] == NO_PEER_SLOT &&
+                peer.state == PeerState::Connected)
+            {
+                chosen[peer.bucket] = slot;
+            }
+        }
+        for (uint8_t bucket = 0; bucket < height; bucket++)
+        {
+            if (chosen[bucket] != NO_PEER_SLOT)
+            {
+                emit(chosen[bucket]);
+            }
+        }
+    }
+};
+
+// ---- Codecs: wire format of share messages ----
+
+// "SHARE:origin:id:timestamp:nonce:parent" text messages
+struct TextCodec
+{
+    static void Encode(const Share& share, std::string& out)
+    {
+        out += share.ToString();
+    }
+
+    static bool Decode(const char* data, size_t length, Share& share)
+    {
+        if (length < 6 || std::memcmp(data, "SHARE:", 6) != 0)
+        {
+            return false;
+        }
+        share = Share::FromString(std::string(data, length));
+        return true;
+    }
+};
+
+// Fixed-size binary messages: tag byte, origin, share id, timestamp, nonce, parent
+struct BinaryCodec
+{
+    static const char TAG = 0x01;
+    static const size_t SIZE = 1 + sizeof(uint32_t) * 4 + sizeof(double);
+
+    static void Encode(const Share& share, std::string& out)
+    {
+        char buffer[SIZE];
+        buffer[0] = TAG;
+        std::memcpy(buffer + 1, &share.originNodeId, sizeof(uint32_t));
+        std::memcpy(buffer + 5, &share.shareId, sizeof(uint32_t));
+        std::memcpy(buffer + 9, &share.timestamp, sizeof(double));
+        std::memcpy(buffer + 17, &share.nonce, sizeof(uint32_t));
+        std::memcpy(buffer + 21, &share.parent, sizeof(uint32_t));
+        out.append(buffer, SIZE);
+    }
+
+    static bool Decode(const char* data, size_t length, Share& share)
+    {
+        if (length != SIZE || data[0] != TAG)
+        {
+            return false;
+        }
+        std::memcpy(&share.originNodeId, data + 1, sizeof(uint32_t));
+        std::memcpy(&share.shareId, data + 5, sizeof(uint32_t));
+        std::memcpy(&share.timestamp, data + 9, sizeof(double));
+        std::memcpy(&share.nonce, data + 17, sizeof(uint32_t));
+        std::memcpy(&share.parent, data + 21, sizeof(uint32_t));
+        return true;
+    }
+};
+
+#endif
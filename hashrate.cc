@@ -0,0 +1,135 @@
+#include "hashrate.h"
+
+#include "ns3/core-module.h"
+
+#include <cmath>
+#include <fstream>
+#include <sstream>
+
+using namespace ns3;
+
+std::vector<double> LoadHashrates(const std::string& path, uint32_t numNodes)
+{
+    std::ifstream file(path);
+    if (!file)
+    {
+        NS_FATAL_ERROR("Cannot open hashrate file '" << path << "'");
+    }
+
+    std::vector<double> hashrates;
+    std::string line;
+    uint32_t lineNumber = 0;
+    while (std::getline(file, line))
+    {
+        lineNumber++;
+        std::istringstream fields(line);
+        std::string value;
+        if (!(fields >> value) || value[0] == '#')
+        {
+            continue;
+        }
+        std::istringstream parsed(value);
+        double hashrate;
+        if (!(parsed >> hashrate) || hashrate <= 0)
+        {
+            NS_FATAL_ERROR(path << ":" << lineNumber << ": expected a positive hashrate");
+        }
+        hashrates.push_back(hashrate);
+    }
+
+    if (hashrates.size() != numNodes)
+    {
+        NS_FATAL_ERROR("Hashrate file '" << path << "' lists " << hashrates.size()
+                                         << " nodes instead of " << numNodes);
+    }
+    return hashrates;
+}
+
+std::vector<double> DrawHashrates(const std::string& distribution,
+                                  uint32_t numNodes,
+                                  double mean,
+                                  double shape,
+                                  std::mt19937& rng)
+{
+    std::vector<double> hashrates(numNodes, mean);
+    if (distribution == "exponential")
+    {
+        std::exponential_distribution<double> dist(1.0 / mean);
+        for (double& hashrate : hashrates)
+        {
+            hashrate = dist(rng);
+        }
+    }
+    else if (distribution == "pareto")
+    {
+        // Inverse transform with the scale that gives the requested mean
+        double scale = mean * (shape - 1.0) / shape;
+        std::uniform_real_distribution<double> uniform(0.0, 1.0);
+        for (double& hashrate : hashrates)
+        {
+            hashrate = scale / std::pow(1.0 - uniform(rng), 1.0 / shape);
+        }
+    }
+    else if (distribution != "equal")
+    {
+        NS_FATAL_ERROR("Unknown hashrate distribution '" << distribution << "'");
+    }
+    return hashrates;
+}
+
+AliasTable::AliasTable()
+{
+}
+
+AliasTable::AliasTable(const std::vector<double>& weights)
+    : probability(weights.size()),
+      alias(weights.size())
+{
+    double total = 0.0;
+    for (double weight : weights)
+    {
+        total += weight;
+    }
+    size_t n = weights.size();
+    std::vector<uint32_t> small;
+    std::vector<uint32_t> large;
+    for (uint32_t i = 0; i < n; i++)
+    {
+        probability[i] = weights[i] * n / total;
+        (probability[i] < 1.0 ? small : large).push_back(i);
+    }
+    while (!small.empty() && !large.empty())
+    {
+        uint32_t less = small.back();
+        small.pop_back();
+        uint32_t more = large.back();
+        alias[less] = more;
+        probability[more] -= 1.0 - probability[less];
+        if (probability[more] < 1.0)
+        {
+            large.pop_back();
+            small.push_back(more);
+        }
+    }
+    // Whatever is left is 1 up to rounding
+    for (uint32_t i : small)
+    {
+        probability[i] = 1.0;
+    }
+    for (uint32_t i : large)
+    {
+        probability[i] = 1.0;
+    }
+}
+
+bool AliasTable::IsEmpty() const
+{
+    return probability.empty();
+}
+
+uint32_t AliasTable::Sample(Pcg32& rng) const
+{
+    uint32_t column = static_cast<uint32_t>((static_cast<uint64_t>(rng()) * probability.size()) >> 32);
+    std::uniform_real_distribution<double> coin(0.0, 1.0);
+    return coin(rng) < probability[column] ? column : alias[column];
+}
@@ -0,0 +1,50 @@
+#ifndef HASHRATE_H
+#define HASHRATE_H
+
+#include "pcgrandom.h"
+
+#include <cstdint>
+#include <random>
+#include <string>
+#include <vector>
+
+// Expected hashes per share at difficulty 1, as in Bitcoin's share difficulty
+const double HASHES_PER_DIFFICULTY = 4294967296.0;
+
+// Reads one hashrate (hashes per second) per node from a file, in node order.
+// Blank lines and lines starting with '#' are skipped; the file must list
+// exactly `numNodes` positive values.
+std::vector<double> LoadHashrates(const std::string& path, uint32_t numNodes);
+
+// Draws a hashrate for every node with the given mean:
+//   equal        every node has the mean
+//   exponential  exponentially distributed
+//   pareto       Pareto distributed with the given shape (> 1); 1.16 gives
+//                the 80/20 split typical of mining pools
+std::vector<double> DrawHashrates(const std::string& distribution,
+                                  uint32_t numNodes,
+                                  double mean,
+                                  double shape,
+                                  std::mt19937& rng);
+
+// Walker's alias table: samples index i with probability weights[i] / sum in
+// O(1) after O(n) setup (Vose's construction)
+class AliasTable
+{
+  private:
+    std::vector<double> probability;
+    std::vector<uint32_t> alias;
+
+  public:
+    AliasTable();
+
+    explicit AliasTable(const std::vector<double>& weights);
+
+    // Returns true if the table holds no weights
+    bool IsEmpty() const;
+
+    // Draws an index
+    uint32_t Sample(Pcg32& rng) const;
+};
+
+#endif
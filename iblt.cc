@@ -0,0 +1,100 @@
+#include "iblt.h"
+
+// SplitMix64 finalizer, salted per use so the cell choices and the checksum are independent
+static uint32_t Mix(uint32_t key, uint64_t salt)
+{
+    uint64_t x = key ^ salt;
+    x = (x ^ (x >> 30)) * 0xBF58476D1CE4E5B9ull;
+    x = (x ^ (x >> 27)) * 0x94D049BB133111EBull;
+    return static_cast<uint32_t>(x ^ (x >> 31));
+}
+
+static const uint64_t CHECK_SALT = 0x9E3779B97F4A7C15ull;
+
+Iblt::Iblt(uint32_t cellCount)
+    : cells((cellCount + HASH_COUNT - 1) / HASH_COUNT * HASH_COUNT, Cell{0, 0, 0})
+{
+}
+
+uint32_t Iblt::CellsFor(uint32_t difference)
+{
+    // About 1.5 cells per key peel reliably for large differences; small ones
+    // need slack or a few keys sharing all their cells stall the peeling
+    return difference + difference / 2 + 4 * HASH_COUNT;
+}
+
+size_t Iblt::CellIndex(uint32_t key, uint32_t partition) const
+{
+    size_t width = cells.size() / HASH_COUNT;
+    return partition * width + Mix(key, partition + 1) % width;
+}
+
+void Iblt::Update(uint32_t key, int32_t sign)
+{
+    uint32_t check = Mix(key, CHECK_SALT);
+    for (uint32_t i = 0; i < HASH_COUNT; i++)
+    {
+        Cell& cell = cells[CellIndex(key, i)];
+        cell.count += sign;
+        cell.keySum ^= key;
+        cell.checkSum ^= check;
+    }
+}
+
+void Iblt::Insert(uint32_t key)
+{
+    Update(key, 1);
+}
+
+void Iblt::Subtract(const Iblt& other)
+{
+    for (size_t i = 0; i < cells.size(); i++)
+    {
+        cells[i].count -= other.cells[i].count;
+        cells[i].keySum ^= other.cells[i].keySum;
+        cells[i].checkSum ^= other.cells[i].checkSum;
+    }
+}
+
+bool Iblt::Decode(std::vector<uint32_t>& onlyHere, std::vector<uint32_t>& onlyThere)
+{
+    // Pure cells hold exactly one key; removing it may make others pure
+    std::vector<size_t> pure;
+    for (size_t i = 0; i < cells.size(); i++)
+    {
+        pure.push_back(i);
+    }
+    while (!pure.empty())
+    {
+        const Cell cell = cells[pure.back()];
+        pure.pop_back();
+        if ((cell.count != 1 && cell.count != -1) || cell.checkSum != Mix(cell.keySum, CHECK_SALT))
+        {
+            continue;
+        }
+        (cell.count > 0 ? onlyHere : onlyThere).push_back(cell.keySum);
+        Update(cell.keySum, -cell.count);
+        for (uint32_t i = 0; i < HASH_COUNT; i++)
+        {
+            pure.push_back(CellIndex(cell.keySum, i));
+        }
+    }
+    for (const Cell& cell : cells)
+    {
+        if (cell.count != 0 || cell.keySum != 0 || cell.checkSum != 0)
+        {
+            return false;
+        }
+    }
+    return true;
+}
+
+uint32_t Iblt::GetCellCount() const
+{
+    return static_cast<uint32_t>(cells.size());
+}
+
+uint32_t Iblt::GetBytes() const
+{
+    return static_cast<uint32_t>(cells.size()) * CELL_BYTES;
+}
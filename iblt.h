@@ -0,0 +1,60 @@
+#ifndef IBLT_H
+#define IBLT_H
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+// Invertible Bloom lookup table over 32-bit keys (Goodrich & Mitzenmacher;
+// Eppstein et al., "What's the difference?"). Each key is added to one cell
+// in each of HASH_COUNT equal partitions. Subtracting the table built by a
+// peer from the local one cancels the keys both sides hold, and what remains
+// can be peeled key by key, so a table sized for the expected difference
+// recovers the symmetric difference of two sets whatever their size.
+class Iblt
+{
+  private:
+    struct Cell
+    {
+        int32_t count;
+        uint32_t keySum;
+        uint32_t checkSum;
+    };
+
+    std::vector<Cell> cells;
+
+    // Returns the cell the key maps to in the given partition
+    size_t CellIndex(uint32_t key, uint32_t partition) const;
+
+    // Adds `sign` copies of the key to its cells
+    void Update(uint32_t key, int32_t sign);
+
+  public:
+    static const uint32_t HASH_COUNT = 3;
+    // Bytes per cell on the wire: a 16-bit count and two 32-bit sums
+    static const uint32_t CELL_BYTES = 10;
+
+    // Creates an empty table with at least the given number of cells
+    explicit Iblt(uint32_t cellCount);
+
+    // Returns a cell count that decodes a difference of `difference` keys with
+    // high probability
+    static uint32_t CellsFor(uint32_t difference);
+
+    void Insert(uint32_t key);
+
+    // Subtracts a table of the same size cell by cell
+    void Subtract(const Iblt& other);
+
+    // Peels the table; keys left with a positive count were only in this
+    // table, keys with a negative count only in the subtracted one. Returns
+    // false if the difference was too large to decode. Empties the table.
+    bool Decode(std::vector<uint32_t>& onlyHere, std::vector<uint32_t>& onlyThere);
+
+    uint32_t GetCellCount() const;
+
+    // Returns the table's size on the wire
+    uint32_t GetBytes() const;
+};
+
+#endif
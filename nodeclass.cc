@@ -0,0 +1,95 @@
+#include "nodeclass.h"
+
+#include "ns3/core-module.h"
+
+#include <algorithm>
+#include <cmath>
+#include <fstream>
+#include <sstream>
+
+using namespace ns3;
+
+std::vector<NodeClass> LoadNodeClasses(const std::string& path)
+{
+    std::ifstream file(path);
+    if (!file)
+    {
+        NS_FATAL_ERROR("Cannot open node class file '" << path << "'");
+    }
+
+    std::vector<NodeClass> classes;
+    std::string line;
+    uint32_t lineNumber = 0;
+    double totalFraction = 0.0;
+    while (std::getline(file, line))
+    {
+        lineNumber++;
+        std::istringstream fields(line);
+        NodeClass nodeClass;
+        if (!(fields >> nodeClass.name) || nodeClass.name[0] == '#')
+        {
+            continue;
+        }
+        if (!(fields >> nodeClass.fraction >> nodeClass.minShareInterval >>
+              nodeClass.maxShareInterval >> nodeClass.uplinkMbps >> nodeClass.downlinkMbps >>
+              nodeClass.targetDegree >> nodeClass.serviceTimeMs))
+        {
+            NS_FATAL_ERROR(path << ":" << lineNumber << ": expected name fraction minInterval "
+                                << "maxInterval uplinkMbps downlinkMbps targetDegree "
+                                << "serviceTimeMs");
+        }
+        if (nodeClass.fraction <= 0 || nodeClass.minShareInterval <= 0 ||
+            nodeClass.maxShareInterval < nodeClass.minShareInterval ||
+            nodeClass.uplinkMbps < 0 || nodeClass.downlinkMbps < 0 ||
+            nodeClass.targetDegree <= 0 || nodeClass.serviceTimeMs < 0)
+        {
+            NS_FATAL_ERROR(path << ":" << lineNumber << ": invalid values for class '"
+                                << nodeClass.name << "'");
+        }
+        totalFraction += nodeClass.fraction;
+        classes.push_back(nodeClass);
+    }
+
+    if (classes.empty())
+    {
+        NS_FATAL_ERROR("Node class file '" << path << "' defines no classes");
+    }
+    if (std::fabs(totalFraction - 1.0) > 1e-6)
+    {
+        NS_FATAL_ERROR("Node class fractions in '" << path << "' sum to " << totalFraction
+                                                    << " instead of 1");
+    }
+    return classes;
+}
+
+std::vector<uint32_t> AssignNodeClasses(const std::vector<NodeClass>& classes,
+                                        uint32_t numNodes,
+                                        std::mt19937& rng)
+{
+    std::vector<uint32_t> counts(classes.size());
+    std::vector<std::pair<double, uint32_t>> remainders;
+    uint32_t assigned = 0;
+    for (uint32_t c = 0; c < classes.size(); c++)
+    {
+        double exact = classes[c].fraction * numNodes;
+        counts[c] = static_cast<uint32_t>(exact);
+        assigned += counts[c];
+        remainders.emplace_back(exact - counts[c], c);
+    }
+    std::sort(remainders.begin(), remainders.end(), [](const auto& a, const auto& b) {
+        return a.first > b.first;
+    });
+    for (uint32_t k = 0; assigned < numNodes; k++, assigned++)
+    {
+        counts[remainders[k].second]++;
+    }
+
+    std::vector<uint32_t> classOf;
+    classOf.reserve(numNodes);
+    for (uint32_t c = 0; c < classes.size(); c++)
+    {
+        classOf.insert(classOf.end(), counts[c], c);
+    }
+    std::shuffle(classOf.begin(), classOf.end(), rng);
+    return classOf;
+}
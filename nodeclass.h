@@ -0,0 +1,38 @@
+#ifndef NODE_CLASS_H
+#define NODE_CLASS_H
+
+#include <cstdint>
+#include <random>
+#include <string>
+#include <vector>
+
+// A tier of nodes sharing generation rate, access bandwidth, degree target and
+// share validation time, making up a fraction of the network
+struct NodeClass
+{
+    std::string name;
+    double fraction;
+    // Shares are generated at intervals drawn uniformly from this range, in seconds
+    double minShareInterval;
+    double maxShareInterval;
+    // Access link capacity; 0 falls back to --uplinkMbps/--downlinkMbps
+    double uplinkMbps;
+    double downlinkMbps;
+    // Expected number of peers
+    double targetDegree;
+    // Mean time to validate a received share; 0 falls back to --serviceTime
+    double serviceTimeMs;
+};
+
+// Reads node classes from a whitespace-separated file with one class per line:
+//   name fraction minInterval maxInterval uplinkMbps downlinkMbps targetDegree serviceTimeMs
+// Blank lines and lines starting with '#' are skipped. Fractions must sum to 1.
+std::vector<NodeClass> LoadNodeClasses(const std::string& path);
+
+// Assigns a class index to each node: class counts follow the fractions
+// (largest remainder rounding) and nodes are shuffled among classes
+std::vector<uint32_t> AssignNodeClasses(const std::vector<NodeClass>& classes,
+                                        uint32_t numNodes,
+                                        std::mt19937& rng);
+
+#endif
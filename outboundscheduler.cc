@@ -0,0 +1,128 @@
+#include "outboundscheduler.h"
+
+#include <algorithm>
+#include <cmath>
+
+// Fraction of a byte a bucket may be short and still send
+static const double TOKEN_SLACK = 0.01;
+
+OutboundScheduler::OutboundScheduler(uint32_t quantumBytes,
+                                     double rateBytesPerSecond,
+                                     uint32_t burstBytes)
+    : quantum(quantumBytes),
+      rate(rateBytesPerSecond),
+      burst(burstBytes)
+{
+}
+
+void OutboundScheduler::Refill(Queue& queue, Time now) const
+{
+    queue.tokens =
+        std::min<double>(burst, queue.tokens + rate * (now - queue.refilledAt).GetSeconds());
+    queue.refilledAt = now;
+}
+
+void OutboundScheduler::Push(uint32_t node, const Outgoing& message)
+{
+    if (nodes.size() <= node)
+    {
+        nodes.resize(node + 1);
+    }
+    NodeQueues& nodeQueues = nodes[node];
+    uint32_t producer = message.delivery.share.originNodeId;
+    auto inserted = nodeQueues.queues.emplace(producer, Queue());
+    Queue& queue = inserted.first->second;
+    if (inserted.second)
+    {
+        // A new producer starts with a full bucket
+        queue.tokens = burst;
+        queue.refilledAt = message.queuedAt;
+    }
+    if (queue.messages.empty())
+    {
+        nodeQueues.active.push_back(producer);
+        stats.peakQueues = std::max(stats.peakQueues, nodeQueues.active.size());
+    }
+    queue.messages.push_back(message);
+    nodeQueues.bytes += message.delivery.bytes;
+    stats.messages++;
+}
+
+bool OutboundScheduler::Pop(uint32_t node, Time now, Outgoing& next, Time& wakeAt)
+{
+    wakeAt = Time();
+    if (node >= nodes.size() || nodes[node].active.empty())
+    {
+        return false;
+    }
+    NodeQueues& nodeQueues = nodes[node];
+    // Queues passed over in a row for lack of tokens; a full round of them
+    // means the uplink has to wait for the earliest refill
+    size_t throttled = 0;
+    Time earliest = Time::Max();
+    while (true)
+    {
+        uint32_t producer = nodeQueues.active.front();
+        Queue& queue = nodeQueues.queues[producer];
+        uint32_t bytes = queue.messages.front().delivery.bytes;
+        if (rate > 0)
+        {
+            Refill(queue, now);
+            // A message larger than the bucket goes out on a full bucket
+            double needed = std::min(bytes, burst);
+            // Tolerates rounding in the refill, which would otherwise wake the
+            // uplink again at the same nanosecond
+            if (queue.tokens + TOKEN_SLACK < needed)
+            {
+                double wait = std::ceil((needed - queue.tokens) / rate * 1e9);
+                earliest = std::min(earliest, now + NanoSeconds(static_cast<int64_t>(wait)));
+                nodeQueues.active.pop_front();
+                nodeQueues.active.push_back(producer);
+                if (++throttled == nodeQueues.active.size())
+                {
+                    stats.rateWaits++;
+                    wakeAt = earliest;
+                    return false;
+                }
+                continue;
+            }
+        }
+        if (queue.deficit < bytes)
+        {
+            // The queue's turn ends; it may send `quantum` bytes more next turn
+            queue.deficit += quantum;
+            nodeQueues.active.pop_front();
+            nodeQueues.active.push_back(producer);
+            throttled = 0;
+            continue;
+        }
+        next = queue.messages.front();
+        queue.messages.pop_front();
+        nodeQueues.bytes -= bytes;
+        queue.deficit -= bytes;
+        queue.tokens -= bytes;
+        if (queue.messages.empty())
+        {
+            // An idle queue does not bank credit for later
+            queue.deficit = 0;
+            nodeQueues.active.pop_front();
+        }
+        return true;
+    }
+}
+
+uint64_t OutboundScheduler::GetQueuedBytes(uint32_t node) const
+{
+    return node < nodes.size() ? nodes[node].bytes : 0;
+}
+
+void OutboundScheduler::Reset()
+{
+    nodes.clear();
+    stats = Stats();
+}
+
+const OutboundScheduler::Stats& OutboundScheduler::GetStats() const
+{
+    return stats;
+}
@@ -0,0 +1,93 @@
+#ifndef OUTBOUND_SCHEDULER_H
+#define OUTBOUND_SCHEDULER_H
+
+#include "p2ptypes.h"
+
+#include <deque>
+#include <unordered_map>
+#include <vector>
+
+using namespace ns3;
+
+// Orders the messages waiting for a node's uplink. With plain FIFO order a
+// producer generating shares much faster than the others fills the uplinks
+// of every relay on its paths, and everyone else's shares queue behind its
+// backlog. Here each relay keeps one queue per originating peer and serves
+// the queues by deficit round robin (Shreedhar & Varghese, "Efficient fair
+// queueing using deficit round robin"): every turn a queue may send up to
+// `quantum` bytes more, so the uplink is split evenly by bytes across the
+// producers with a backlog. Each queue can also be capped by a token bucket
+// of `rate` bytes per second and `burst` bytes, which holds a producer to its
+// rate even when the uplink has room to spare. Messages without a share
+// (requests) have a queue of their own.
+//
+// The scheduler only keeps the queues; the network serializes what it hands
+// out and asks for the next message when the uplink is free.
+class OutboundScheduler
+{
+  public:
+    // A message waiting for the uplink
+    struct Outgoing
+    {
+        Delivery delivery;
+        uint32_t toNode;
+        Time delay;    // link delay once serialized
+        Time queuedAt;
+    };
+
+    // Counters over all nodes
+    struct Stats
+    {
+        uint64_t messages = 0;  // messages queued
+        uint64_t rateWaits = 0; // times an uplink idled because every backlogged queue was out of tokens
+        size_t peakQueues = 0;  // most producers backlogged at one node at once
+    };
+
+  private:
+    // Backlog, round robin deficit and token bucket of one producer at one node
+    struct Queue
+    {
+        std::deque<Outgoing> messages;
+        uint32_t deficit = 0;
+        double tokens = 0.0;
+        Time refilledAt;
+    };
+
+    struct NodeQueues
+    {
+        std::unordered_map<uint32_t, Queue> queues;
+        std::deque<uint32_t> active; // producers with a backlog, in round robin order
+        uint64_t bytes = 0;          // queued over all producers
+    };
+
+    uint32_t quantum;
+    double rate; // bytes per second, 0 = unlimited
+    uint32_t burst;
+    std::vector<NodeQueues> nodes;
+    Stats stats;
+
+    // Adds the tokens earned since the queue was last refilled
+    void Refill(Queue& queue, Time now) const;
+
+  public:
+    OutboundScheduler(uint32_t quantumBytes, double rateBytesPerSecond, uint32_t burstBytes);
+
+    // Queues a message for the node's uplink behind the others of its producer
+    void Push(uint32_t node, const Outgoing& message);
+
+    // Takes the node's next message in round robin order; returns false if
+    // there is none, setting `wakeAt` to when a throttled queue can send again
+    // (zero if nothing is queued)
+    bool Pop(uint32_t node, Time now, Outgoing& next, Time& wakeAt);
+
+    // Returns the bytes queued for the node's uplink
+    uint64_t GetQueuedBytes(uint32_t node) const;
+
+    // Drops every queued message and token bucket and clears the counters
+    // (used between ensemble replications)
+    void Reset();
+
+    const Stats& GetStats() const;
+};
+
+#endif
@@ -1,24 +1,213 @@
+#include "abstractnetwork.h"
+#include "connectionbootstrap.h"
+#include "countingscheduler.h"
+#include "generationdriver.h"
+#include "gf256.h"
+#include "gossipmetrics.h"
+#include "hashrate.h"
+#include "nodeclass.h"
 #include "p2pnode.h"
+#include "processingmodel.h"
+#include "proofofwork.h"
+#include "reconciliation.h"
+#include "sharechain.h"
+#include "stoppingrule.h"
 
 #include "ns3/ipv4-global-routing-helper.h"
 #include "ns3/netanim-module.h"
 #include "ns3/point-to-point-module.h"
 
+#include <algorithm>
+#include <chrono>
 #include <cmath>
 #include <map>
 #include <memory>
+#include <numeric>
 
 NS_LOG_COMPONENT_DEFINE("P2PGossipNetworkSimulation");
 
 using namespace ns3;
 
+// Most chunks a coded payload may have; every node decoding a share holds a
+// square matrix of coefficients this wide
+const uint32_t MAX_CODED_CHUNKS = 1024;
+
+// Parameters of a single simulation run
+struct ScenarioConfig
+{
+    uint32_t numNodes = 10;
+    double connectionProbability = 0.3;
+    double simulationTime = 60.0;
+    double latencyMs = 5.0;
+    // Per-node access link capacity shared by all of a node's peer links
+    // (0 gives every peer link its own 5Mbps pipe instead); a downlink of 0
+    // is as fast as the uplink
+    double uplinkMbps = 0.0;
+    double downlinkMbps = 0.0;
+    // Uplink scheduling over the abstract transport: fifo, or drr (one queue
+    // per producer served by deficit round robin with `drrQuantum` bytes per
+    // turn), optionally capping each producer's queue with a token bucket of
+    // `peerRateMbps` (0 = no cap) and `peerBurstBytes`
+    std::string uplinkScheduler = "fifo";
+    uint32_t drrQuantum = 1500;
+    double peerRateMbps = 0.0;
+    uint32_t peerBurstBytes = 65536;
+    // Payload carried by every share over the abstract transport, the chunk
+    // size it is split into (0 = one message) and whether nodes relay chunks
+    // as they arrive instead of after the whole share
+    uint32_t payloadBytes = 0;
+    uint32_t chunkBytes = 0;
+    bool cutThrough = false;
+    // Network coding: chunks travel as random linear combinations over
+    // GF(2^8), with row operations done by the named kernel (auto, scalar,
+    // ssse3, avx2)
+    bool networkCoding = false;
+    std::string gf256Kernel = "auto";
+    // Compact relay: payloads are announced as short IDs of `components`
+    // components, of which a receiver already holds a fraction `poolOverlap`
+    bool compactRelay = false;
+    uint32_t components = 2000;
+    double poolOverlap = 0.95;
+    // Set reconciliation: nodes flood shares to their first `floodPeers` peers
+    // and reconcile with the rest every `reconIntervalMs`
+    bool reconciliation = false;
+    uint32_t floodPeers = 4;
+    double reconIntervalMs = 1000.0;
+    // Share validation: mean service time per share (0 forwards at once), cores
+    // per node and the service time distribution (constant or exponential)
+    double serviceTimeMs = 0.0;
+    uint32_t cpuCores = 1;
+    std::string serviceDistribution = "constant";
+    // Proof of work: leading zero bits required of a share's header hash (0 =
+    // shares are not mined or checked), shares checked per SHA-256 batch (0 =
+    // one per kernel lane) and the SHA-256 kernel (auto, scalar, sse41, avx2)
+    uint32_t powBits = 0;
+    uint32_t powBatch = 0;
+    std::string sha256Kernel = "auto";
+    // Sharechain: shares reference their miner's best tip; stale shares and
+    // forks are counted among shares at least `confirmations` below the tip
+    bool shareChain = false;
+    uint32_t confirmations = 6;
+    // Missing-parent fetch: how long a node waits for a GETSHARE answer and
+    // how many peers it asks before dropping the orphans waiting on it
+    double fetchTimeoutMs = 500.0;
+    uint32_t fetchAttempts = 3;
+    // Hashrate-weighted mining: node hashrates (H/s) drawn from a distribution
+    // (equal, exponential, pareto; empty = uniform share intervals instead) or
+    // read from a file, and the share difficulty (0 = keep the share rate of
+    // the interval model)
+    std::string hashrate;
+    std::string hashrateFile;
+    double hashrateMean = 1e12;
+    double hashrateShape = 1.16;
+    double difficulty = 0.0;
+    // File defining node classes; empty makes all nodes alike
+    std::string nodeClassFile;
+    // Overlay shape: flat (one random graph) or hierarchical (clusters whose
+    // elected relays form a random graph among themselves)
+    std::string topology = "flat";
+    uint32_t clusterSize = 32;
+    uint32_t relaysPerCluster = 1;
+    double relayDegree = 8.0;
+    // Peers picked per k-bucket in a kadcast overlay
+    uint32_t kadcastK = 3;
+    uint32_t seed = 0;
+    std::string transport = "tcp";
+    std::string scheduler = "map";
+    std::string dedup = "hashset";
+    std::string forward = "flood";
+    std::string codec = "text";
+    std::string tcpProfile = "default";
+    bool centralGeneration = true;
+    uint32_t replications = 1;
+    double drainTime = 2.0;
+    // Connection bootstrap: handshakes in flight at once (0 = all) and the
+    // maximum random delay before each one starts
+    uint32_t bootstrapConcurrency = 0;
+    double bootstrapJitterMs = 0.0;
+    // Sequential stopping: relative half-width target of the latency and coverage
+    // confidence intervals (0 runs for the full simulation time)
+    double relativePrecision = 0.0;
+    double batchTime = 5.0;
+    uint32_t minBatches = 10;
+    double coverageHorizon = 2.0;
+    bool countEvents = false;
+    bool enableNetAnim = true;
+    bool printStats = true;
+};
+
+// Measurements collected from a single simulation run
+struct RunReport
+{
+    double wallSeconds = 0.0;
+    double simulatedSeconds = 0.0;
+    double bootstrapSeconds = 0.0;
+    // First-receipt latency in seconds
+    double latencyMean = 0.0;
+    double latencyP50 = 0.0;
+    double latencyP90 = 0.0;
+    double latencyP99 = 0.0;
+    uint64_t events = 0;
+    uint64_t peakQueueSize = 0;
+    uint32_t sharesGenerated = 0;
+    uint32_t sharesSent = 0;
+    double coverage = 0.0;
+    // Wall-clock cost of checking one share's proof of work, and shares per check
+    double powNsPerShare = 0.0;
+    double powMeanBatch = 0.0;
+    // Sharechain: fraction of settled shares off the main chain, forks per main-chain share
+    double staleRate = 0.0;
+    double forkRate = 0.0;
+    // Compact relay: fraction of full-relay bytes saved, component round trips per announcement
+    double compactSavings = 0.0;
+    double roundTripsPerShare = 0.0;
+    // Abstract transport: bytes sent per generated share and node
+    double bytesPerShare = 0.0;
+    // Peers per node once the overlay is built
+    double meanDegree = 0.0;
+    // Latency of the shares of the node that generated the most and of all
+    // other shares, and Jain's fairness index over the mean latency of every
+    // producer's shares (1 = all equal)
+    double topProducerLatency = 0.0;
+    double otherLatency = 0.0;
+    double latencyFairness = 0.0;
+};
+
+// Simulation of a gossip network made of NodeT nodes (a BasicP2PNode instantiation)
+template <typename NodeT>
 class P2PGossipNetworkSimulation
 {
   private:
+    ScenarioConfig config;
+    TcpProfile tcpProfile;
+    std::vector<NodeClass> nodeClasses;
+    // Class index of every node, empty without node classes
+    std::vector<uint32_t> classOf;
+    // Cluster index of every node, empty in a flat overlay
+    std::vector<uint32_t> clusterOf;
+    std::vector<uint32_t> relays;
+    // Hashrate of every node and the share difficulty, empty without a mining model
+    std::vector<double> hashrates;
+    double shareDifficulty;
     NodeContainer nodes;
+    // Per-node access routers when access links are modelled in TCP mode
+    NodeContainer routers;
     InternetStackHelper internet;
     Ipv4AddressHelper addressHelper;
-    std::vector<std::shared_ptr<P2PNode>> p2pNodes;
+    Ipv4AddressHelper accessAddressHelper;
+    // Address of each node on its access link, where its server socket is reached
+    std::vector<Ipv4Address> accessAddresses;
+    // Nodes are stored by value in one contiguous block; it is reserved up front and
+    // never grows, so the node addresses bound into ns-3 callbacks stay valid
+    std::vector<NodeT> p2pNodes;
+    ShareGenerationDriver<NodeT> generationDriver;
+    GossipMetrics metrics;
+    SequentialStoppingRule stoppingRule;
+    ConnectionBootstrap bootstrap;
+    // Single runs start generating shares once the overlay is ready; ensembles
+    // stop the simulator there and start each replication themselves
+    bool generateWhenReady;
+    Time connectionsAt;
 
     struct ConnectionInfo
     {
@@ -28,6 +217,15 @@ class P2PGossipNetworkSimulation
     };
 
     std::map<std::pair<uint32_t, uint32_t>, ConnectionInfo> connections;
+    // Sockets whose handshake is in progress, with the node pair they connect
+    std::map<Ptr<Socket>, std::pair<uint32_t, uint32_t>> dialing;
+
+    std::unique_ptr<AbstractNetwork> abstractNetwork;
+    std::unique_ptr<ProcessingModel> processingModel;
+    std::unique_ptr<ShareChain> shareChain;
+    std::unique_ptr<Reconciliation> reconciliation;
+    // Link delay between two nodes in abstract transport mode
+    std::map<std::pair<uint32_t, uint32_t>, Time> abstractLinks;
 
     uint32_t totalMessagesSent;
     uint32_t totalMessagesReceived;
@@ -36,17 +234,149 @@ class P2PGossipNetworkSimulation
     AnimationInterface* anim;
 
   public:
-    // Constructor: Creates the network with the specified number of nodes
-    P2PGossipNetworkSimulation(uint32_t numNodes)
+    // Constructor: Creates the network with the number of nodes given in the scenario
+    P2PGossipNetworkSimulation(const ScenarioConfig& scenario)
+        : config(scenario),
+          tcpProfile(TcpProfileFromName(scenario.tcpProfile)),
+          shareDifficulty(0.0),
+          metrics(scenario.numNodes),
+          stoppingRule(scenario.relativePrecision, 0.95, scenario.minBatches),
+          generateWhenReady(true),
+          totalMessagesSent(0),
+          totalMessagesReceived(0),
+          anim(nullptr)
     {
-        nodes.Create(numNodes);
-        internet.Install(nodes);
+        uint32_t numNodes = config.numNodes;
+        if (!config.nodeClassFile.empty())
+        {
+            nodeClasses = LoadNodeClasses(config.nodeClassFile);
+            std::mt19937 classRng(config.seed + 1);
+            classOf = AssignNodeClasses(nodeClasses, numNodes, classRng);
+            metrics.SetNodeClasses(classOf, nodeClasses.size());
+        }
+        if (HasAccessLinks())
+        {
+            for (uint32_t i = 0; i < numNodes; i++)
+            {
+                if (UplinkMbps(i) <= 0)
+                {
+                    NS_FATAL_ERROR("Node " << i << " has no uplink capacity; set --uplinkMbps "
+                                           << "or an uplink for every node class");
+                }
+            }
+        }
+
+        if (HasProcessingModel())
+        {
+            processingModel = std::make_unique<ProcessingModel>(
+                numNodes,
+                config.serviceDistribution == "exponential"
+                    ? ProcessingModel::ServiceDistribution::Exponential
+                    : ProcessingModel::ServiceDistribution::Constant,
+                config.seed);
+            processingModel->SetValidatedCallback(
+                MakeCallback(&P2PGossipNetworkSimulation::ForwardValidated, this));
+            for (uint32_t i = 0; i < numNodes; i++)
+            {
+                processingModel->SetNodeCpu(i, config.cpuCores, MilliSeconds(ServiceTimeMs(i)));
+            }
+            if (config.powBits > 0)
+            {
+                Sha256Kernel kernel;
+                Sha256KernelFromName(config.sha256Kernel, kernel);
+                processingModel->EnableProofOfWork(
+                    config.powBits,
+                    kernel,
+                    config.powBatch > 0 ? config.powBatch : Sha256KernelLanes(kernel));
+            }
+        }
+
+        if (config.shareChain)
+        {
+            shareChain = std::make_unique<ShareChain>(numNodes);
+            shareChain->SetFetchPolicy(MilliSeconds(config.fetchTimeoutMs), config.fetchAttempts);
+        }
+
+        if (IsAbstract())
+        {
+            abstractNetwork = std::make_unique<AbstractNetwork>();
+            for (uint32_t i = 0; HasAccessLinks() && i < numNodes; i++)
+            {
+                abstractNetwork->SetAccessLink(i, UplinkRate(i), DownlinkRate(i));
+            }
+            if (config.uplinkScheduler == "drr")
+            {
+                abstractNetwork->SetFairQueueing(config.drrQuantum,
+                                                 config.peerRateMbps * 1e6 / 8.0,
+                                                 config.peerBurstBytes);
+            }
+            abstractNetwork->SetPayload(config.payloadBytes, config.chunkBytes, config.cutThrough);
+            if (config.networkCoding)
+            {
+                Gf256Kernel kernel;
+                Gf256KernelFromName(config.gf256Kernel, kernel);
+                abstractNetwork->SetNetworkCoding(kernel, config.seed);
+            }
+            if (config.compactRelay)
+            {
+                abstractNetwork->SetCompactRelay(config.components, config.poolOverlap);
+            }
+            if (config.reconciliation)
+            {
+                reconciliation = std::make_unique<Reconciliation>(
+                    abstractNetwork.get(), MilliSeconds(config.reconIntervalMs));
+                abstractNetwork->SetReconciliation(reconciliation.get());
+            }
+        }
+        else
+        {
+            nodes.Create(numNodes);
+            internet.Install(nodes);
+            if (HasAccessLinks())
+            {
+                CreateAccessLinks();
+            }
+        }
 
+        p2pNodes.reserve(numNodes);
         for (uint32_t i = 0; i < numNodes; i++)
         {
-            std::shared_ptr<P2PNode> node = std::make_shared<P2PNode>(i);
-            p2pNodes.push_back(node);
+            p2pNodes.emplace_back(i, config.seed);
+            p2pNodes.back().AttachMetrics(&metrics);
+            if (processingModel)
+            {
+                p2pNodes.back().AttachProcessing(processingModel.get());
+            }
+            if (shareChain)
+            {
+                p2pNodes.back().AttachShareChain(shareChain.get());
+            }
+            if (!classOf.empty())
+            {
+                const NodeClass& nodeClass = nodeClasses[classOf[i]];
+                p2pNodes.back().SetShareInterval(Seconds(nodeClass.minShareInterval),
+                                                 Seconds(nodeClass.maxShareInterval));
+            }
+            if (abstractNetwork)
+            {
+                p2pNodes.back().AttachNetwork(abstractNetwork.get());
+            }
+            if (config.centralGeneration)
+            {
+                generationDriver.AddNode(&p2pNodes.back());
+            }
+        }
+        if (HasMiningModel())
+        {
+            SetUpMining();
+        }
+        if (abstractNetwork)
+        {
+            abstractNetwork->SetReceiveCallback(
+                MakeCallback(&P2PGossipNetworkSimulation::DeliverToNode, this));
         }
+        bootstrap.SetOpenCallback(MakeCallback(&P2PGossipNetworkSimulation::OpenConnection, this));
+        bootstrap.SetReadyCallback(MakeCallback(&P2PGossipNetworkSimulation::OnOverlayReady, this));
     }
 
     // Destructor: Cleans up animation resources
@@ -58,20 +388,202 @@ class P2PGossipNetworkSimulation
         }
     }
 
-    // Creates a random network topology with given connection probability and latency
-    void CreateRandomTopology(double connectionProbability = 0.3, double latency = 5.0)
+    // Hands a batch from the abstract network to its destination node
+    void DeliverToNode(uint32_t nodeId, const std::vector<Delivery>& batch)
     {
-        uint32_t numNodes = nodes.GetN();
-        std::random_device rd;
-        std::mt19937 rng(rd());
-        std::uniform_real_distribution<double> dist(0.0, 1.0);
+        p2pNodes[nodeId].HandleDeliveries(batch);
+    }
+
+    // Returns true when shares follow node hashrates instead of uniform intervals
+    bool HasMiningModel() const
+    {
+        return !config.hashrate.empty() || !config.hashrateFile.empty();
+    }
+
+    // Loads or draws node hashrates, fixes the difficulty and turns every
+    // node's share generation into a Poisson process at hashrate / (difficulty * 2^32)
+    void SetUpMining()
+    {
+        uint32_t numNodes = config.numNodes;
+        if (!config.hashrateFile.empty())
+        {
+            hashrates = LoadHashrates(config.hashrateFile, numNodes);
+        }
+        else
+        {
+            std::mt19937 hashrateRng(config.seed + 2);
+            hashrates = DrawHashrates(config.hashrate,
+                                      numNodes,
+                                      config.hashrateMean,
+                                      config.hashrateShape,
+                                      hashrateRng);
+        }
+
+        double totalHashrate = 0.0;
+        double intervalRate = 0.0;
+        for (uint32_t i = 0; i < numNodes; i++)
+        {
+            totalHashrate += hashrates[i];
+            double minInterval = classOf.empty() ? 2.0 : nodeClasses[classOf[i]].minShareInterval;
+            double maxInterval = classOf.empty() ? 5.0 : nodeClasses[classOf[i]].maxShareInterval;
+            intervalRate += 2.0 / (minInterval + maxInterval);
+        }
+        shareDifficulty = config.difficulty > 0
+                              ? config.difficulty
+                              : totalHashrate / (intervalRate * HASHES_PER_DIFFICULTY);
 
+        std::vector<double> rates(numNodes);
         for (uint32_t i = 0; i < numNodes; i++)
         {
+            rates[i] = hashrates[i] / (shareDifficulty * HASHES_PER_DIFFICULTY);
+            p2pNodes[i].SetShareRate(rates[i]);
+        }
+        if (config.centralGeneration)
+        {
+            generationDriver.SetShareRates(rates, config.seed);
+        }
+    }
+
+    // Hands a validated share back to its node for forwarding
+    void ForwardValidated(uint32_t nodeId, const Share& share, uint32_t peerSlot)
+    {
+        p2pNodes[nodeId].ForwardValidatedShare(share, peerSlot);
+    }
+
+    // Returns the node's mean validation time: its class's if set, else the global one
+    double ServiceTimeMs(uint32_t node) const
+    {
+        if (!classOf.empty() && nodeClasses[classOf[node]].serviceTimeMs > 0)
+        {
+            return nodeClasses[classOf[node]].serviceTimeMs;
+        }
+        return config.serviceTimeMs;
+    }
+
+    // Returns true when received shares are validated on a modelled CPU before forwarding
+    bool HasProcessingModel() const
+    {
+        if (config.serviceTimeMs > 0 || config.powBits > 0)
+        {
+            return true;
+        }
+        for (const NodeClass& nodeClass : nodeClasses)
+        {
+            if (nodeClass.serviceTimeMs > 0)
+            {
+                return true;
+            }
+        }
+        return false;
+    }
+
+    // Returns true when shares travel over abstract links instead of the TCP/IP stack
+    bool IsAbstract() const
+    {
+        return config.transport == "abstract";
+    }
+
+    // Returns true when every node has one access link shared by its peer links
+    bool HasAccessLinks() const
+    {
+        if (config.uplinkMbps > 0)
+        {
+            return true;
+        }
+        for (const NodeClass& nodeClass : nodeClasses)
+        {
+            if (nodeClass.uplinkMbps > 0)
+            {
+                return true;
+            }
+        }
+        return false;
+    }
+
+    // Returns the node's uplink capacity: its class's if set, else the global one
+    double UplinkMbps(uint32_t node) const
+    {
+        if (!classOf.empty() && nodeClasses[classOf[node]].uplinkMbps > 0)
+        {
+            return nodeClasses[classOf[node]].uplinkMbps;
+        }
+        return config.uplinkMbps;
+    }
+
+    // Returns the node's downlink capacity, defaulting to its uplink capacity
+    double DownlinkMbps(uint32_t node) const
+    {
+        if (!classOf.empty() && nodeClasses[classOf[node]].downlinkMbps > 0)
+        {
+            return nodeClasses[classOf[node]].downlinkMbps;
+        }
+        return config.downlinkMbps > 0 ? config.downlinkMbps : UplinkMbps(node);
+    }
+
+    DataRate UplinkRate(uint32_t node) const
+    {
+        return DataRate(static_cast<uint64_t>(UplinkMbps(node) * 1e6));
+    }
+
+    DataRate DownlinkRate(uint32_t node) const
+    {
+        return DataRate(static_cast<uint64_t>(DownlinkMbps(node) * 1e6));
+    }
+
+    // Attaches every node to its own access router; the node's device sends at
+    // the uplink rate and the router's device at the downlink rate. Peer links
+    // then join the routers, so all of a node's connections share its access link.
+    void CreateAccessLinks()
+    {
+        routers.Create(config.numNodes);
+        internet.Install(routers);
+        accessAddressHelper.SetBase(Ipv4Address("172.16.0.0"), Ipv4Mask("255.255.255.252"));
+
+        PointToPointHelper accessHelper;
+        accessHelper.SetChannelAttribute("Delay", TimeValue(Seconds(0)));
+        for (uint32_t i = 0; i < config.numNodes; i++)
+        {
+            NetDeviceContainer devices = accessHelper.Install(nodes.Get(i), routers.Get(i));
+            devices.Get(0)->SetAttribute("DataRate", DataRateValue(UplinkRate(i)));
+            devices.Get(1)->SetAttribute("DataRate", DataRateValue(DownlinkRate(i)));
+            Ipv4InterfaceContainer ifc = accessAddressHelper.Assign(devices);
+            accessAddresses.push_back(ifc.GetAddress(0));
+            accessAddressHelper.NewNetwork();
+        }
+    }
+
+    // Returns the probability that nodes i and j are linked: the connection
+    // probability, or with node classes min(1, d_i d_j / sum d) so that every
+    // node's expected degree is its class's target degree (Chung-Lu)
+    double LinkProbability(uint32_t i, uint32_t j, double connectionProbability, double degreeSum) const
+    {
+        if (classOf.empty())
+        {
+            return connectionProbability;
+        }
+        double degreeI = nodeClasses[classOf[i]].targetDegree;
+        double degreeJ = nodeClasses[classOf[j]].targetDegree;
+        return std::min(1.0, degreeI * degreeJ / degreeSum);
+    }
+
+    // Links the members pairwise with the probability given for each pair;
+    // a member without links to later members is linked to its predecessor
+    template <typename Probability>
+    void ConnectRandomGraph(const std::vector<uint32_t>& members,
+                            Probability probability,
+                            double latency,
+                            std::mt19937& rng)
+    {
+        std::uniform_real_distribution<double> dist(0.0, 1.0);
+        size_t count = members.size();
+        for (size_t a = 0; a < count && count > 1; a++)
+        {
+            uint32_t i = members[a];
             bool connected = false;
-            for (uint32_t j = i + 1; j < numNodes; j++)
+            for (size_t b = a + 1; b < count; b++)
             {
-                if (dist(rng) < connectionProbability)
+                uint32_t j = members[b];
+                if (dist(rng) < probability(i, j))
                 {
                     connected = true;
                     ConnectNodes(i, j, latency);
@@ -79,42 +591,280 @@ class P2PGossipNetworkSimulation
             }
 
             if(!connected){
-                if(i==0 && numNodes>0)  ConnectNodes(0, 1, latency);
-                else ConnectNodes(i,i-1,latency);
+                if(a==0)  ConnectNodes(members[0], members[1], latency);
+                else ConnectNodes(i,members[a-1],latency);
+            }
+        }
+    }
+
+    // Returns the relays elected among a cluster's members: those with the most
+    // uplink capacity, then the highest class degree target, then the lowest id
+    std::vector<uint32_t> ElectRelays(std::vector<uint32_t> members) const
+    {
+        auto capacity = [this](uint32_t node) {
+            double uplink = HasAccessLinks() ? UplinkMbps(node) : 0.0;
+            double degree = classOf.empty() ? 0.0 : nodeClasses[classOf[node]].targetDegree;
+            return std::make_pair(uplink, degree);
+        };
+        std::stable_sort(members.begin(), members.end(), [&](uint32_t a, uint32_t b) {
+            return capacity(a) > capacity(b);
+        });
+        members.resize(std::min<size_t>(members.size(), config.relaysPerCluster));
+        return members;
+    }
+
+    // Groups consecutive nodes into clusters of clusterSize. Every member links
+    // to its cluster's relays and stops forwarding; the relays of a cluster are
+    // fully linked, and relays of different clusters form a random graph with
+    // relayDegree expected links each, so shares cross clusters only between
+    // relays and fan out within a cluster from its relays.
+    void CreateHierarchy(double latency, std::mt19937& rng)
+    {
+        uint32_t numNodes = config.numNodes;
+        clusterOf.resize(numNodes);
+        for (uint32_t first = 0; first < numNodes; first += config.clusterSize)
+        {
+            std::vector<uint32_t> members;
+            for (uint32_t i = first; i < std::min(numNodes, first + config.clusterSize); i++)
+            {
+                members.push_back(i);
+                clusterOf[i] = first / config.clusterSize;
+            }
+            std::vector<uint32_t> clusterRelays = ElectRelays(members);
+            for (uint32_t member : members)
+            {
+                bool isRelay = std::find(clusterRelays.begin(), clusterRelays.end(), member) !=
+                               clusterRelays.end();
+                p2pNodes[member].SetRelaying(isRelay);
+                for (uint32_t relay : clusterRelays)
+                {
+                    if (!isRelay || member < relay)
+                    {
+                        ConnectNodes(std::min(member, relay), std::max(member, relay), latency);
+                    }
+                }
             }
+            relays.insert(relays.end(), clusterRelays.begin(), clusterRelays.end());
         }
 
-        Ipv4GlobalRoutingHelper::PopulateRoutingTables();
+        std::sort(relays.begin(), relays.end());
+        double relayProbability =
+            relays.size() > 1 ? std::min(1.0, config.relayDegree / (relays.size() - 1)) : 0.0;
+        ConnectRandomGraph(
+            relays,
+            [&](uint32_t i, uint32_t j) {
+                return clusterOf[i] == clusterOf[j] ? 0.0 : relayProbability;
+            },
+            latency,
+            rng);
+        NS_LOG_INFO("Hierarchical overlay: " << (numNodes + config.clusterSize - 1) /
+                                                    config.clusterSize
+                                             << " clusters, " << relays.size() << " relays");
+    }
+
+    // Builds k-bucket peer tables: every node links to up to kadcastK nodes,
+    // sampled uniformly, from each of its buckets (nodes whose overlay id first
+    // differs from its own at that bit). Links are symmetric and so are
+    // buckets, so peers added by the other end are valid bucket entries too.
+    // With the nodes sorted by overlay id, bucket b of a node is the range of
+    // ids sharing its bits above b and differing at b, so every bucket is
+    // found by binary search and sampled on its own, in O(N log N) overall.
+    void CreateKadcastOverlay(double latency, std::mt19937& rng)
+    {
+        uint32_t numNodes = config.numNodes;
+        uint32_t k = config.kadcastK;
+        std::vector<std::pair<uint32_t, uint32_t>> byId(numNodes);
         for (uint32_t i = 0; i < numNodes; i++)
         {
-            p2pNodes[i]->SetupServerSocket(nodes.Get(i));
+            byId[i] = std::make_pair(KadcastId(i), i);
+        }
+        std::sort(byId.begin(), byId.end());
+        std::vector<uint32_t> picked;
+        for (uint32_t i = 0; i < numNodes; i++)
+        {
+            uint64_t id = KadcastId(i);
+            for (uint8_t bucket = 0; bucket < KADCAST_BUCKETS; bucket++)
+            {
+                uint64_t low = ((id >> bucket) ^ 1) << bucket;
+                uint64_t high = low + (uint64_t(1) << bucket);
+                auto first = std::lower_bound(byId.begin(), byId.end(),
+                                              std::make_pair(static_cast<uint32_t>(low), 0u));
+                auto last = high > std::numeric_limits<uint32_t>::max()
+                                ? byId.end()
+                                : std::lower_bound(first, byId.end(),
+                                                   std::make_pair(static_cast<uint32_t>(high), 0u));
+                uint32_t size = static_cast<uint32_t>(last - first);
+                // Floyd's sampling of min(k, size) distinct positions in the bucket
+                picked.clear();
+                for (uint32_t n = size - std::min(k, size); n < size; n++)
+                {
+                    std::uniform_int_distribution<uint32_t> pick(0, n);
+                    uint32_t position = pick(rng);
+                    if (std::find(picked.begin(), picked.end(), position) != picked.end())
+                    {
+                        position = n;
+                    }
+                    picked.push_back(position);
+                }
+                for (uint32_t position : picked)
+                {
+                    uint32_t j = first[position].second;
+                    ConnectNodes(std::min(i, j), std::max(i, j), latency);
+                }
+            }
+        }
+    }
+
+    // Creates a random network topology with given connection probability and latency
+    void CreateRandomTopology(double connectionProbability = 0.3, double latency = 5.0)
+    {
+        uint32_t numNodes = config.numNodes;
+        std::mt19937 rng(config.seed);
+        if (config.topology == "hierarchical")
+        {
+            CreateHierarchy(latency, rng);
+        }
+        else if (config.topology == "kadcast")
+        {
+            CreateKadcastOverlay(latency, rng);
+        }
+        else
+        {
+            double degreeSum = 0.0;
+            for (uint32_t nodeClass : classOf)
+            {
+                degreeSum += nodeClasses[nodeClass].targetDegree;
+            }
+            std::vector<uint32_t> allNodes(numNodes);
+            std::iota(allNodes.begin(), allNodes.end(), 0);
+            ConnectRandomGraph(
+                allNodes,
+                [&](uint32_t i, uint32_t j) {
+                    return LinkProbability(i, j, connectionProbability, degreeSum);
+                },
+                latency,
+                rng);
+        }
+
+        if (!IsAbstract())
+        {
+            Ipv4GlobalRoutingHelper::PopulateRoutingTables();
+            for (uint32_t i = 0; i < numNodes; i++)
+            {
+                p2pNodes[i].SetupServerSocket(
+                    nodes.Get(i),
+                    tcpProfile,
+                    MakeCallback(&P2PGossipNetworkSimulation::OnRegistered, this));
+            }
         }
 
-        Simulator::Schedule(Seconds(5) + Simulator::Now(),
+        connectionsAt = Simulator::Now() + Seconds(5);
+        Simulator::Schedule(connectionsAt - Simulator::Now(),
                             &P2PGossipNetworkSimulation::makeconnections,
                             this);
     }
 
-    // Establishes socket connections between all connected node pairs
+    // Starts the bootstrap that establishes connections between all connected node pairs
     void makeconnections()
     {
-        for (const auto& connection : connections)
+        bootstrap.Start(config.bootstrapConcurrency,
+                        MilliSeconds(config.bootstrapJitterMs),
+                        config.seed);
+    }
+
+    // Opens the connection between node i and node j for the bootstrap
+    void OpenConnection(uint32_t i, uint32_t j)
+    {
+        if (IsAbstract())
+        {
+            // The handshake takes one round trip over the link
+            Simulator::Schedule(abstractLinks[{i, j}] * 2,
+                                &P2PGossipNetworkSimulation::CompleteAbstractLink,
+                                this,
+                                i,
+                                j);
+            return;
+        }
+        ConnectPeerSockets(i, j);
+    }
+
+    // Adds both ends of an abstract link once its handshake is done
+    void CompleteAbstractLink(uint32_t i, uint32_t j)
+    {
+        Time delay = abstractLinks[{i, j}];
+        p2pNodes[i].AddAbstractPeer(j, delay);
+        p2pNodes[j].AddAbstractPeer(i, delay);
+        bootstrap.NotifyDone(true);
+    }
+
+    // Called when every overlay connection has been opened or has failed
+    void OnOverlayReady()
+    {
+        if (reconciliation)
+        {
+            StartReconciliation();
+        }
+        if (!generateWhenReady)
+        {
+            Simulator::Stop();
+            return;
+        }
+        StartGeneration();
+        if (config.relativePrecision > 0)
+        {
+            Simulator::Schedule(Seconds(config.batchTime),
+                                &P2PGossipNetworkSimulation::CloseBatch,
+                                this);
+        }
+    }
+
+    // Makes every node reconcile with the peers after its first floodPeers and
+    // starts the reconciliation rounds
+    void StartReconciliation()
+    {
+        for (uint32_t i = 0; i < config.numNodes; i++)
         {
-            uint32_t i = connection.first.first;
-            uint32_t j = connection.first.second;
-            ConnectPeerSockets(i, j);
+            const std::vector<PeerEntry>& peers = p2pNodes[i].GetPeers();
+            for (uint32_t slot = config.floodPeers; slot < peers.size(); slot++)
+            {
+                reconciliation->AddLink(i, peers[slot].peerId, peers[slot].linkDelay);
+            }
         }
+        reconciliation->Start(config.seed);
+        NS_LOG_INFO("Reconciling on " << reconciliation->GetLinkCount() << " of "
+                                      << abstractLinks.size() << " links");
+    }
+
+    // Returns true if ConnectNodes already linked node i to node j
+    bool IsLinked(uint32_t i, uint32_t j) const
+    {
+        return IsAbstract() ? abstractLinks.count({i, j}) > 0 : connections.count({i, j}) > 0;
     }
 
     // Creates a physical connection between two nodes with the given latency
     void ConnectNodes(uint32_t i, uint32_t j, double latencyMs)
     {
+        // The fallback link of a graph may repeat a pair that is already linked
+        if (IsLinked(i, j) || IsLinked(j, i))
+        {
+            return;
+        }
+        bootstrap.AddConnection(i, j);
+        if (IsAbstract())
+        {
+            abstractLinks[{i, j}] = MilliSeconds(latencyMs);
+            return;
+        }
+
         PointToPointHelper p2pHelper;
-        p2pHelper.SetDeviceAttribute("DataRate", StringValue("5Mbps"));
+        // Behind access links a peer link is a fast core path between the two routers
+        const NodeContainer& endpoints = HasAccessLinks() ? routers : nodes;
+        p2pHelper.SetDeviceAttribute("DataRate",
+                                     StringValue(HasAccessLinks() ? "10Gbps" : "5Mbps"));
         p2pHelper.SetChannelAttribute("Delay", TimeValue(MilliSeconds(latencyMs)));
         NodeContainer linkNodes;
-        linkNodes.Add(nodes.Get(i));
-        linkNodes.Add(nodes.Get(j));
+        linkNodes.Add(endpoints.Get(i));
+        linkNodes.Add(endpoints.Get(j));
         NetDeviceContainer linkDevices = p2pHelper.Install(linkNodes);
 
         std::ostringstream network;
@@ -133,20 +883,52 @@ class P2PGossipNetworkSimulation
     void ConnectPeerSockets(uint32_t i, uint32_t j)
     {
         auto& conn = connections[{i, j}];
-        Ipv4Address addrJ = conn.ifc.GetAddress(1);
+        Ipv4Address addrJ = HasAccessLinks() ? accessAddresses[j] : conn.ifc.GetAddress(1);
 
         Ptr<Socket> socket = Socket::CreateSocket(nodes.Get(i), TcpSocketFactory::GetTypeId());
+        ApplyTcpProfile(socket, tcpProfile);
+
+        socket->SetConnectCallback(MakeCallback(&P2PGossipNetworkSimulation::OnConnected, this),
+                                   MakeCallback(&P2PGossipNetworkSimulation::OnConnectFailed, this));
+        socket->SetRecvCallback(MakeCallback(&NodeT::HandleRead, &p2pNodes[i]));
+        dialing[socket] = {i, j};
 
         socket->Connect(InetSocketAddress(addrJ, j + 1000));
+    }
+
+    // Registers a connected socket with its node once the handshake succeeded
+    void OnConnected(Ptr<Socket> socket)
+    {
+        auto it = dialing.find(socket);
+        NS_ASSERT(it != dialing.end());
+        uint32_t i = it->second.first;
+        uint32_t j = it->second.second;
+        dialing.erase(it);
+
+        p2pNodes[i].AddPeerSocket(j, socket);
+        // The connection counts as open once the acceptor has the dialer's
+        // REGISTER, since only then can both ends send on it
+        if (!p2pNodes[i].RegisterWithPeer(j))
+        {
+            bootstrap.NotifyDone(false);
+        }
+    }
 
-        socket->SetRecvCallback(MakeCallback(&P2PNode::HandleRead, p2pNodes[i].get()));
+    // Completes a bootstrap connection once its acceptor knows the dialer
+    void OnRegistered(uint32_t /*node*/, uint32_t /*peerId*/, bool kept)
+    {
+        bootstrap.NotifyDone(kept);
+    }
 
-        p2pNodes[i]->AddPeerSocket(j, socket);
-        p2pNodes[i]->AddPeer(j);
-        std::string reg = "REGISTER:" + std::to_string(i);
-        Ptr<Packet> packet =
-            Create<Packet>(reinterpret_cast<const uint8_t*>(reg.c_str()), reg.length());
-        socket->Send(packet);
+    // Drops a socket whose handshake failed
+    void OnConnectFailed(Ptr<Socket> socket)
+    {
+        auto it = dialing.find(socket);
+        NS_ASSERT(it != dialing.end());
+        NS_LOG_INFO("Connection from node " << it->second.first << " to node "
+                                            << it->second.second << " failed");
+        dialing.erase(it);
+        bootstrap.NotifyDone(false);
     }
 
     // Configures the NetAnim visualization for the network
@@ -164,12 +946,16 @@ class P2PGossipNetworkSimulation
             int row = i / gridSize;
             int col = i % gridSize;
             anim->SetConstantPosition(nodes.Get(i), 100.0 * col, 100.0 * row);
+            if (HasAccessLinks())
+            {
+                anim->SetConstantPosition(routers.Get(i), 100.0 * col + 30.0, 100.0 * row + 30.0);
+            }
 
             std::ostringstream desc;
             desc << "Node " << i;
             anim->UpdateNodeDescription(nodes.Get(i), desc.str());
 
-            size_t degree = p2pNodes[i]->GetPeers().size();
+            size_t degree = p2pNodes[i].GetPeers().size();
             if (degree > 4)
             {
                 anim->UpdateNodeColor(nodes.Get(i), 255, 0, 0);
@@ -190,22 +976,28 @@ class P2PGossipNetworkSimulation
     }
 
     // Starts the simulation and runs it for the specified time with periodic statistics
-    void Start(double simulationTime = 100.0, double statsInterval = 10.0)
+    RunReport Start(double simulationTime = 100.0, double statsInterval = 10.0)
     {
-        SetupNetAnim();
-        for (auto& node : p2pNodes)
+        if (config.enableNetAnim && !IsAbstract())
         {
-            node->StartGeneratingShares();
+            SetupNetAnim();
         }
+        // Share generation starts from OnOverlayReady
+        generateWhenReady = true;
 
-        for (double t = statsInterval; t < simulationTime; t += statsInterval)
+        if (config.printStats)
         {
-            Simulator::Schedule(Seconds(t), &P2PGossipNetworkSimulation::PrintPeriodicStats, this);
-        }
+            for (double t = statsInterval; t < simulationTime; t += statsInterval)
+            {
+                Simulator::Schedule(Seconds(t),
+                                    &P2PGossipNetworkSimulation::PrintPeriodicStats,
+                                    this);
+            }
 
-        Simulator::Schedule(Seconds(simulationTime - 0.1),
-                            &P2PGossipNetworkSimulation::PrintStatistics,
-                            this);
+            Simulator::Schedule(Seconds(simulationTime - 0.1),
+                                &P2PGossipNetworkSimulation::PrintStatistics,
+                                this);
+        }
 
         Simulator::Schedule(Seconds(simulationTime - 0.1),
                             &P2PGossipNetworkSimulation::StopAllNodes,
@@ -213,20 +1005,279 @@ class P2PGossipNetworkSimulation
 
         NS_LOG_INFO("Starting gossip network simulation for " << simulationTime << " seconds");
         Simulator::Stop(Seconds(simulationTime));
+
+        RunReport report;
+        auto wallStart = std::chrono::steady_clock::now();
         Simulator::Run();
+        std::chrono::duration<double> wall = std::chrono::steady_clock::now() - wallStart;
+        report.wallSeconds = wall.count();
+        report.simulatedSeconds = Simulator::Now().GetSeconds();
+        report.bootstrapSeconds = bootstrap.IsReady() ? bootstrap.GetDuration().GetSeconds() : 0.0;
+        const LogHistogram& latencies = metrics.GetLatencyHistogram();
+        report.latencyMean = metrics.GetLatency().GetMean();
+        report.latencyP50 = latencies.GetQuantile(0.50);
+        report.latencyP90 = latencies.GetQuantile(0.90);
+        report.latencyP99 = latencies.GetQuantile(0.99);
+        report.coverage = metrics.GetMeanCoverage();
+        report.events = Simulator::GetEventCount();
+        if (config.countEvents)
+        {
+            report.peakQueueSize = CountingScheduler::GetPeakSize();
+        }
+        for (const auto& node : p2pNodes)
+        {
+            report.sharesGenerated += node.GetSharesGenerated();
+            report.sharesSent += node.GetSharesSent();
+            report.meanDegree += node.GetPeers().size();
+        }
+        report.meanDegree /= p2pNodes.size();
+        if (processingModel && processingModel->HasProofOfWork())
+        {
+            ProcessingModel::PowStats pow = processingModel->GetPowTotals();
+            report.powNsPerShare = pow.validated > 0 ? pow.validateSeconds * 1e9 / pow.validated : 0.0;
+            report.powMeanBatch =
+                pow.batches > 0 ? static_cast<double>(pow.validated) / pow.batches : 0.0;
+        }
+        if (shareChain)
+        {
+            ShareChain::Summary summary = shareChain->Analyze(config.confirmations);
+            report.staleRate = summary.staleRate;
+            report.forkRate = summary.forkRate;
+        }
+        if (abstractNetwork && abstractNetwork->IsCompact())
+        {
+            const AbstractNetwork::CompactStats& compact = abstractNetwork->GetCompactStats();
+            report.compactSavings =
+                compact.fullBytes > 0
+                    ? 1.0 - static_cast<double>(compact.compactBytes) / compact.fullBytes
+                    : 0.0;
+            report.roundTripsPerShare =
+                compact.announcements > 0
+                    ? static_cast<double>(compact.roundTrips) / compact.announcements
+                    : 0.0;
+        }
+        FillProducerLatency(report);
+        if (abstractNetwork && report.sharesGenerated > 0)
+        {
+            report.bytesPerShare = static_cast<double>(abstractNetwork->GetBytesSent()) /
+                                   (static_cast<double>(report.sharesGenerated) * config.numNodes);
+        }
+
         Simulator::Destroy();
+        return report;
     }
 
-    // closes all the connections.
-    void StopAllNodes()
+    // Compares the latency of the largest producer's shares with everyone
+    // else's and computes Jain's index over the producers' mean latencies
+    void FillProducerLatency(RunReport& report) const
     {
-        for (auto& node : p2pNodes)
+        uint32_t top = 0;
+        for (uint32_t i = 1; i < config.numNodes; i++)
         {
-            node->Stop();
+            if (p2pNodes[i].GetSharesGenerated() > p2pNodes[top].GetSharesGenerated())
+            {
+                top = i;
+            }
         }
-        NS_LOG_INFO("All nodes stopped.");
-    }
-
+        SampleStats others;
+        double sum = 0.0;
+        double sumOfSquares = 0.0;
+        uint32_t producers = 0;
+        for (uint32_t i = 0; i < config.numNodes; i++)
+        {
+            const SampleStats& latency = metrics.GetOriginLatency(i);
+            if (latency.GetCount() == 0)
+            {
+                continue;
+            }
+            sum += latency.GetMean();
+            sumOfSquares += latency.GetMean() * latency.GetMean();
+            producers++;
+            if (i != top)
+            {
+                others.Add(latency.GetMean());
+            }
+        }
+        report.topProducerLatency = metrics.GetOriginLatency(top).GetMean();
+        report.otherLatency = others.GetMean();
+        report.latencyFairness = sumOfSquares > 0 ? sum * sum / (producers * sumOfSquares) : 0.0;
+    }
+
+    // Runs several replications on the topology built once: the overlay connects a
+    // single time, and before each replication only the gossip state is reset and
+    // share generation is reseeded. Validations and abstract network messages left
+    // over from the previous replication are cancelled; TCP segments in flight
+    // cannot be, so with sockets drainTime has to cover them. Reports mean and
+    // confidence interval per metric.
+    RunReport RunEnsemble(uint32_t replications, double simulationTime)
+    {
+        RunReport report;
+        auto wallStart = std::chrono::steady_clock::now();
+
+        // Let the overlay finish connecting before the first replication
+        generateWhenReady = false;
+        Simulator::Run();
+        if (!bootstrap.IsReady())
+        {
+            NS_FATAL_ERROR("Overlay bootstrap did not complete");
+        }
+        report.bootstrapSeconds = bootstrap.GetDuration().GetSeconds();
+
+        SampleStats generated;
+        SampleStats latencyMs;
+        SampleStats coverage;
+        SampleStats messagesPerShare;
+        SampleStats staleRate;
+        for (uint32_t r = 0; r < replications; r++)
+        {
+            // Replication r draws from stream r of the run seed, so no two
+            // (seed, replication) pairs share a generation seed
+            Pcg32 replicationStream(config.seed, r);
+            uint64_t generationSeed =
+                static_cast<uint64_t>(replicationStream()) << 32 | replicationStream();
+            if (abstractNetwork)
+            {
+                abstractNetwork->Reset(generationSeed);
+            }
+            if (processingModel)
+            {
+                processingModel->Reset(generationSeed);
+            }
+            for (auto& node : p2pNodes)
+            {
+                node.ResetGossipState(generationSeed);
+            }
+            generationDriver.Reseed(generationSeed);
+            metrics.Reset();
+            if (shareChain)
+            {
+                shareChain->Reset();
+            }
+            if (reconciliation)
+            {
+                reconciliation->Reset();
+            }
+
+            StartGeneration();
+            Simulator::Schedule(Seconds(simulationTime),
+                                &P2PGossipNetworkSimulation::StopGeneration,
+                                this);
+            // In-flight shares drain before the state is reset for the next replication
+            Simulator::Stop(Seconds(simulationTime + config.drainTime));
+            Simulator::Run();
+
+            uint64_t sent = 0;
+            for (const auto& node : p2pNodes)
+            {
+                sent += node.GetSharesSent();
+            }
+            uint64_t shares = metrics.GetSharesGenerated();
+            generated.Add(shares);
+            latencyMs.Add(metrics.GetLatency().GetMean() * 1000.0);
+            coverage.Add(metrics.GetMeanCoverage());
+            messagesPerShare.Add(shares > 0 ? static_cast<double>(sent) / shares : 0.0);
+            report.sharesGenerated += shares;
+            report.sharesSent += sent;
+            if (shareChain)
+            {
+                staleRate.Add(shareChain->Analyze(config.confirmations).staleRate);
+            }
+            NS_LOG_INFO("Replication " << r << " (generation seed " << generationSeed
+                                       << "): " << shares << " shares, mean latency "
+                                       << metrics.GetLatency().GetMean() * 1000.0
+                                       << " ms, coverage " << metrics.GetMeanCoverage());
+        }
+
+        std::chrono::duration<double> wall = std::chrono::steady_clock::now() - wallStart;
+        report.wallSeconds = wall.count();
+        report.events = Simulator::GetEventCount();
+        StopAllNodes();
+        Simulator::Destroy();
+
+        NS_LOG_INFO("=== Ensemble of " << replications << " replications (mean +/- 95% CI) ===");
+        NS_LOG_INFO("Bootstrap duration: " << report.bootstrapSeconds << "s");
+        NS_LOG_INFO("Shares generated: " << generated.GetMean() << " +/- "
+                                         << generated.GetHalfWidth());
+        NS_LOG_INFO("Mean propagation latency (ms): " << latencyMs.GetMean() << " +/- "
+                                                      << latencyMs.GetHalfWidth());
+        NS_LOG_INFO("Coverage: " << coverage.GetMean() << " +/- " << coverage.GetHalfWidth());
+        NS_LOG_INFO("Messages per share: " << messagesPerShare.GetMean() << " +/- "
+                                           << messagesPerShare.GetHalfWidth());
+        if (shareChain)
+        {
+            NS_LOG_INFO("Stale share rate: " << staleRate.GetMean() << " +/- "
+                                             << staleRate.GetHalfWidth());
+        }
+        return report;
+    }
+
+    // Closes one batch of latency and coverage observations and ends the run once
+    // the stopping rule is satisfied. Coverage of a share is fixed coverageHorizon
+    // seconds after its creation, which also bounds the memory held per share.
+    void CloseBatch()
+    {
+        metrics.FinalizeShares(config.coverageHorizon);
+        GossipMetrics::Batch batch = metrics.TakeBatch();
+        // Batches without deliveries or finalized shares carry no estimate
+        if (batch.latency.GetCount() > 0 && batch.coverage.GetCount() > 0)
+        {
+            stoppingRule.AddBatch(batch.latency.GetMean(), batch.coverage.GetMean());
+            if (stoppingRule.IsSatisfied())
+            {
+                NS_LOG_INFO("Stopping rule satisfied at " << Simulator::Now().GetSeconds()
+                                                          << "s of " << config.simulationTime
+                                                          << "s");
+                if (config.printStats)
+                {
+                    PrintStatistics();
+                }
+                StopAllNodes();
+                Simulator::Stop();
+                return;
+            }
+        }
+        Simulator::Schedule(Seconds(config.batchTime),
+                            &P2PGossipNetworkSimulation::CloseBatch,
+                            this);
+    }
+
+    // Starts share generation on all nodes, centrally or with per-node timers
+    void StartGeneration()
+    {
+        if (config.centralGeneration)
+        {
+            generationDriver.Start();
+        }
+        else
+        {
+            for (auto& node : p2pNodes)
+            {
+                node.StartGeneratingShares();
+            }
+        }
+    }
+
+    // Stops share generation on all nodes without closing connections
+    void StopGeneration()
+    {
+        generationDriver.Stop();
+        for (auto& node : p2pNodes)
+        {
+            node.StopGeneratingShares();
+        }
+    }
+
+    // closes all the connections.
+    void StopAllNodes()
+    {
+        generationDriver.Stop();
+        for (auto& node : p2pNodes)
+        {
+            node.Stop();
+        }
+        NS_LOG_INFO("All nodes stopped.");
+    }
+
     // Prints periodic statistics during simulation
     void PrintPeriodicStats()
     {
@@ -239,9 +1290,9 @@ class P2PGossipNetworkSimulation
 
         for (const auto& node : p2pNodes)
         {
-            totalShares += node->GetProcessedSharesCount();
-            totalGenerated += node->GetSharesGenerated();
-            totalSocketConnections += node->GetPeerSocketsCount();
+            totalShares += node.GetProcessedSharesCount();
+            totalGenerated += node.GetSharesGenerated();
+            totalSocketConnections += node.GetPeerSocketsCount();
         }
 
         NS_LOG_INFO("Total shares generated: " << totalGenerated);
@@ -262,52 +1313,1352 @@ class P2PGossipNetworkSimulation
 
         for (const auto& node : p2pNodes)
         {
-            totalSharesReceived += node->GetSharesReceived();
-            totalSharesGenerated += node->GetSharesGenerated();
-            totalSharesForwarded += node->GetSharesForwarded();
-            totalSharesSent += node->GetSharesSent();
-            totalSocketConnections += node->GetPeerSocketsCount();
+            totalSharesReceived += node.GetSharesReceived();
+            totalSharesGenerated += node.GetSharesGenerated();
+            totalSharesForwarded += node.GetSharesForwarded();
+            totalSharesSent += node.GetSharesSent();
+            totalSocketConnections += node.GetPeerSocketsCount();
 
-            NS_LOG_INFO("Node " << node->GetId() << ": Generated " << node->GetSharesGenerated()
-                                << ", Received " << node->GetSharesReceived() << ", Forwarded "
-                                << node->GetSharesForwarded() << ", Total sent "
-                                << node->GetSharesSent() << ", Total processed "
-                                << node->GetProcessedSharesCount() << ", Peer count "
-                                << node->GetPeers().size() << ", Socket connections "
-                                << node->GetPeerSocketsCount());
+            NS_LOG_INFO("Node " << node.GetId() << ": Generated " << node.GetSharesGenerated()
+                                << ", Received " << node.GetSharesReceived() << ", Forwarded "
+                                << node.GetSharesForwarded() << ", Total sent "
+                                << node.GetSharesSent() << ", Total processed "
+                                << node.GetProcessedSharesCount() << ", Peer count "
+                                << node.GetPeers().size() << ", Socket connections "
+                                << node.GetPeerSocketsCount());
+            if (processingModel)
+            {
+                uint32_t i = node.GetId();
+                NS_LOG_INFO("Node " << i << ": CPU utilization "
+                                    << processingModel->GetNodeUtilization(i, Simulator::Now()) *
+                                           100.0
+                                    << "%, mean validation wait "
+                                    << processingModel->GetNodeWait(i).GetMean() * 1000.0
+                                    << " ms, peak queue " << processingModel->GetNodePeakQueue(i));
+            }
+            if (processingModel && processingModel->HasProofOfWork())
+            {
+                const ProcessingModel::PowStats& pow = processingModel->GetNodePow(node.GetId());
+                NS_LOG_INFO("Node " << node.GetId() << ": proofs checked " << pow.validated
+                                    << " in " << pow.batches << " batches ("
+                                    << (pow.validated > 0 ? pow.validateSeconds * 1e9 / pow.validated
+                                                          : 0.0)
+                                    << " ns/share wall), rejected " << pow.rejected
+                                    << ", mining " << pow.mineSeconds * 1000.0 << " ms wall");
+            }
         }
 
         NS_LOG_INFO("Total shares generated: " << totalSharesGenerated);
         NS_LOG_INFO("Total shares received: " << totalSharesReceived);
         NS_LOG_INFO("Total shares forwarded: " << totalSharesForwarded);
         NS_LOG_INFO("Total shares sent: " << totalSharesSent);
+        NS_LOG_INFO("Messages per share: "
+                    << (totalSharesGenerated > 0
+                            ? static_cast<double>(totalSharesSent) / totalSharesGenerated
+                            : 0.0));
         NS_LOG_INFO("Total socket connections: " << totalSocketConnections);
+        if (bootstrap.IsReady())
+        {
+            NS_LOG_INFO("Bootstrap duration: " << bootstrap.GetDuration().GetSeconds() << "s, "
+                                               << bootstrap.GetFailedCount()
+                                               << " failed connections");
+        }
+        else
+        {
+            NS_LOG_INFO("Bootstrap did not complete; no shares were generated");
+        }
+        NS_LOG_INFO("Mean propagation latency: " << metrics.GetLatency().GetMean() * 1000.0
+                                                 << " ms over " << metrics.GetLatency().GetCount()
+                                                 << " deliveries, mean coverage "
+                                                 << metrics.GetMeanCoverage());
+        const LogHistogram& latencies = metrics.GetLatencyHistogram();
+        NS_LOG_INFO("Propagation latency percentiles: p50 "
+                    << latencies.GetQuantile(0.50) * 1000.0 << " ms, p90 "
+                    << latencies.GetQuantile(0.90) * 1000.0 << " ms, p99 "
+                    << latencies.GetQuantile(0.99) * 1000.0 << " ms");
+        if (!classOf.empty())
+        {
+            PrintClassStatistics();
+        }
+        if (config.relativePrecision > 0)
+        {
+            SequentialStoppingRule::Estimate latency = stoppingRule.GetLatencyEstimate();
+            SequentialStoppingRule::Estimate coverage = stoppingRule.GetCoverageEstimate();
+            NS_LOG_INFO("Batch means after " << stoppingRule.GetWarmupBatches() << " of "
+                                             << stoppingRule.GetBatchCount()
+                                             << " batches dropped as warm-up: latency "
+                                             << latency.mean * 1000.0 << " +/- "
+                                             << latency.halfWidth * 1000.0 << " ms, coverage "
+                                             << coverage.mean << " +/- " << coverage.halfWidth
+                                             << " (95% CI, " << latency.batches << " batches)");
+        }
+
+        size_t totalHeapBytes = 0;
+        for (const auto& node : p2pNodes)
+        {
+            totalHeapBytes += node.GetHeapBytes();
+        }
+        NS_LOG_INFO("Node memory: " << sizeof(NodeT) << " bytes inline + "
+                                    << totalHeapBytes / p2pNodes.size()
+                                    << " bytes heap per node on average");
+        if (abstractNetwork)
+        {
+            NS_LOG_INFO("Abstract network: " << abstractNetwork->GetDeliveriesSent()
+                                             << " deliveries coalesced into "
+                                             << abstractNetwork->GetEventsScheduled()
+                                             << " events");
+        }
+        if (abstractNetwork && abstractNetwork->HasAccessLinks())
+        {
+            PrintAccessLinkStatistics();
+        }
+        if (abstractNetwork && abstractNetwork->IsCompact())
+        {
+            PrintCompactRelayStatistics();
+        }
+        if (abstractNetwork && abstractNetwork->IsCoded())
+        {
+            PrintNetworkCodingStatistics();
+        }
+        if (abstractNetwork && abstractNetwork->GetFairQueueingStats())
+        {
+            PrintFairQueueingStatistics();
+        }
+        if (reconciliation)
+        {
+            PrintReconciliationStatistics();
+        }
+        if (processingModel)
+        {
+            PrintProcessingStatistics();
+        }
+        if (shareChain)
+        {
+            PrintShareChainStatistics();
+        }
+        if (!hashrates.empty())
+        {
+            PrintMiningStatistics();
+        }
+    }
+
+    // Prints the hashrate skew and how much of the share traffic the largest miners originate
+    void PrintMiningStatistics()
+    {
+        std::vector<uint32_t> byHashrate(config.numNodes);
+        for (uint32_t i = 0; i < config.numNodes; i++)
+        {
+            byHashrate[i] = i;
+        }
+        std::sort(byHashrate.begin(), byHashrate.end(), [this](uint32_t a, uint32_t b) {
+            return hashrates[a] > hashrates[b];
+        });
+        double totalHashrate = 0.0;
+        uint64_t totalShares = 0;
+        for (uint32_t i = 0; i < config.numNodes; i++)
+        {
+            totalHashrate += hashrates[i];
+            totalShares += p2pNodes[i].GetSharesGenerated();
+        }
+        NS_LOG_INFO("Mining: total hashrate " << totalHashrate << " H/s, difficulty "
+                                              << shareDifficulty << ", expected "
+                                              << totalHashrate /
+                                                     (shareDifficulty * HASHES_PER_DIFFICULTY)
+                                              << " shares/s network-wide");
+        for (double fraction : {0.01, 0.1})
+        {
+            uint32_t top = std::max<uint32_t>(1, fraction * config.numNodes);
+            double topHashrate = 0.0;
+            uint64_t topShares = 0;
+            for (uint32_t k = 0; k < top; k++)
+            {
+                topHashrate += hashrates[byHashrate[k]];
+                topShares += p2pNodes[byHashrate[k]].GetSharesGenerated();
+            }
+            NS_LOG_INFO("Largest " << top << " miners: " << 100.0 * topHashrate / totalHashrate
+                                   << "% of hashrate, "
+                                   << (totalShares > 0 ? 100.0 * topShares / totalShares : 0.0)
+                                   << "% of generated shares");
+        }
+    }
+
+    // Prints the bytes compact relay saved over full payloads and the round trips it added
+    void PrintCompactRelayStatistics()
+    {
+        const AbstractNetwork::CompactStats& compact = abstractNetwork->GetCompactStats();
+        NS_LOG_INFO("Compact relay: " << compact.announcements << " shares rebuilt, "
+                                      << compact.roundTrips << " needed a round trip ("
+                                      << compact.componentsRequested
+                                      << " components requested), " << compact.compactBytes
+                                      << " bytes on the wire vs " << compact.fullBytes
+                                      << " for full payloads ("
+                                      << static_cast<int64_t>(compact.fullBytes) -
+                                             static_cast<int64_t>(compact.compactBytes)
+                                      << " bytes saved)");
+    }
+
+    // Prints how often token buckets held uplinks back and how the largest
+    // producer's shares fared against the others
+    void PrintFairQueueingStatistics()
+    {
+        const OutboundScheduler::Stats& stats = *abstractNetwork->GetFairQueueingStats();
+        RunReport report;
+        FillProducerLatency(report);
+        NS_LOG_INFO("Fair queueing: " << stats.messages << " messages scheduled, "
+                                      << stats.rateWaits
+                                      << " uplink waits for tokens, at most "
+                                      << stats.peakQueues << " producers backlogged at a node");
+        NS_LOG_INFO("Producer latency: largest producer " << report.topProducerLatency * 1000.0
+                                                          << " ms, others "
+                                                          << report.otherLatency * 1000.0
+                                                          << " ms, Jain's index "
+                                                          << report.latencyFairness);
+    }
+
+    // Prints how many coded packets were innovative and how many bytes each
+    // node sent per share
+    void PrintNetworkCodingStatistics()
+    {
+        const AbstractNetwork::CodingStats& coding = abstractNetwork->GetCodingStats();
+        NS_LOG_INFO("Network coding: " << abstractNetwork->GetChunkCount() << " chunks per share, "
+                                       << coding.packets << " coded packets received, "
+                                       << coding.innovative << " innovative ("
+                                       << (coding.packets > 0
+                                               ? 100.0 * coding.innovative / coding.packets
+                                               : 0.0)
+                                       << "%), " << coding.decoded << " shares decoded, "
+                                       << coding.notices << " decoded notices, "
+                                       << abstractNetwork->GetBytesSent() << " bytes sent");
+    }
+
+    // Prints how many reconciliation rounds ran, how large the set differences
+    // were and what the sketches cost on the wire
+    void PrintReconciliationStatistics()
+    {
+        const Reconciliation::Stats& stats = reconciliation->GetStats();
+        NS_LOG_INFO("Reconciliation: " << stats.rounds << " rounds on "
+                                       << reconciliation->GetLinkCount() << " links, "
+                                       << stats.decodeFailures << " sketches failed to decode, "
+                                       << stats.fallbacks << " full exchanges, mean difference "
+                                       << stats.difference.GetMean() << ", "
+                                       << stats.reconciledShares << " shares sent after a round, "
+                                       << stats.sketchBytes << " bytes of sketches and requests");
+        NS_LOG_INFO("Abstract network: " << abstractNetwork->GetBytesSent() << " bytes sent");
+    }
+
+    // Prints stale shares and forks of the sharechain, overall and per node class
+    void PrintShareChainStatistics()
+    {
+        ShareChain::Summary summary = shareChain->Analyze(config.confirmations);
+        uint64_t reorgs = 0;
+        for (uint32_t i = 0; i < config.numNodes; i++)
+        {
+            reorgs += shareChain->GetNodeReorgs(i);
+        }
+        NS_LOG_INFO("Sharechain: " << shareChain->GetShareCount() << " shares, main chain height "
+                                   << summary.mainHeight << ", " << summary.staleShares << " of "
+                                   << summary.settledShares << " settled shares stale ("
+                                   << summary.staleRate * 100.0 << "%), " << summary.forks
+                                   << " forks (" << summary.forkRate
+                                   << " per main-chain share), "
+                                   << static_cast<double>(reorgs) / config.numNodes
+                                   << " reorgs per node");
+        const ShareChain::FetchStats& fetch = shareChain->GetFetchStats();
+        NS_LOG_INFO("Parent fetch: " << fetch.orphans << " orphans, " << fetch.requests
+                                     << " requests (" << fetch.retries << " retries, "
+                                     << fetch.failures << " failed), " << fetch.served
+                                     << " served, latency mean "
+                                     << fetch.latency.GetMean() * 1000.0 << " ms, p90 "
+                                     << fetch.latencyHistogram.GetQuantile(0.9) * 1000.0
+                                     << " ms, orphan buffer peak " << fetch.peakOrphans
+                                     << " shares ("
+                                     << fetch.peakOrphans * sizeof(FetchState::Orphan)
+                                     << " bytes), " << fetch.dropped << " dropped");
+        if (classOf.empty())
+        {
+            return;
+        }
+        std::vector<uint32_t> stale(nodeClasses.size(), 0);
+        std::vector<uint32_t> settled(nodeClasses.size(), 0);
+        for (uint32_t i = 0; i < config.numNodes; i++)
+        {
+            stale[classOf[i]] += summary.staleByOrigin[i];
+            settled[classOf[i]] += summary.settledByOrigin[i];
+        }
+        for (uint32_t c = 0; c < nodeClasses.size(); c++)
+        {
+            NS_LOG_INFO("Class " << nodeClasses[c].name << ": " << stale[c] << " of " << settled[c]
+                                 << " settled shares stale ("
+                                 << (settled[c] > 0 ? 100.0 * stale[c] / settled[c] : 0.0)
+                                 << "%)");
+        }
+    }
+
+    // Prints validation queueing over all nodes and the busiest CPU
+    void PrintProcessingStatistics()
+    {
+        uint32_t busiest = 0;
+        double busiestUtilization = 0.0;
+        double totalUtilization = 0.0;
+        for (uint32_t i = 0; i < config.numNodes; i++)
+        {
+            double utilization = processingModel->GetNodeUtilization(i, Simulator::Now());
+            totalUtilization += utilization;
+            if (utilization > busiestUtilization)
+            {
+                busiest = i;
+                busiestUtilization = utilization;
+            }
+        }
+        NS_LOG_INFO("Validation: mean wait " << processingModel->GetWait().GetMean() * 1000.0
+                                             << " ms over " << processingModel->GetWait().GetCount()
+                                             << " shares, mean CPU utilization "
+                                             << totalUtilization / config.numNodes * 100.0
+                                             << "%, busiest node " << busiest << " at "
+                                             << busiestUtilization * 100.0 << "% (peak queue "
+                                             << processingModel->GetNodePeakQueue(busiest) << ")");
+        if (processingModel->HasProofOfWork())
+        {
+            ProcessingModel::PowStats pow = processingModel->GetPowTotals();
+            Sha256Kernel kernel = processingModel->GetKernel();
+            NS_LOG_INFO("Proof of work (" << config.powBits << " bits, "
+                                          << Sha256KernelName(kernel) << " kernel, "
+                                          << Sha256KernelLanes(kernel) << " lanes): "
+                                          << pow.validated << " proofs checked in " << pow.batches
+                                          << " batches, "
+                                          << (pow.validated > 0
+                                                  ? pow.validateSeconds * 1e9 / pow.validated
+                                                  : 0.0)
+                                          << " ns/share wall, " << pow.rejected << " rejected; "
+                                          << pow.mined << " shares mined with "
+                                          << (pow.mined > 0
+                                                  ? static_cast<double>(pow.mineHashes) / pow.mined
+                                                  : 0.0)
+                                          << " hashes each, " << pow.mineSeconds * 1000.0
+                                          << " ms wall");
+        }
+    }
+
+    // Prints metrics broken down by node class: latency is measured at the
+    // class's nodes as receivers, coverage over the shares they originated
+    void PrintClassStatistics()
+    {
+        for (uint32_t c = 0; c < nodeClasses.size(); c++)
+        {
+            uint32_t members = 0;
+            size_t degrees = 0;
+            uint32_t generated = 0;
+            for (uint32_t i = 0; i < config.numNodes; i++)
+            {
+                if (classOf[i] == c)
+                {
+                    members++;
+                    degrees += p2pNodes[i].GetPeers().size();
+                    generated += p2pNodes[i].GetSharesGenerated();
+                }
+            }
+            const LogHistogram& latencies = metrics.GetClassLatencyHistogram(c);
+            NS_LOG_INFO("Class " << nodeClasses[c].name << ": " << members << " nodes, mean degree "
+                                 << (members > 0 ? static_cast<double>(degrees) / members : 0.0)
+                                 << ", " << generated << " shares generated, latency mean "
+                                 << metrics.GetClassLatency(c).GetMean() * 1000.0 << " ms, p50 "
+                                 << latencies.GetQuantile(0.50) * 1000.0 << " ms, p90 "
+                                 << latencies.GetQuantile(0.90) * 1000.0
+                                 << " ms, coverage of its shares "
+                                 << metrics.GetClassMeanCoverage(c));
+        }
+    }
+
+    // Prints queueing on the abstract access links and the busiest uplink and downlink
+    void PrintAccessLinkStatistics()
+    {
+        double elapsed = Simulator::Now().GetSeconds();
+        uint32_t busiestUplink = 0;
+        uint32_t busiestDownlink = 0;
+        for (uint32_t i = 1; i < config.numNodes; i++)
+        {
+            if (abstractNetwork->GetUplinkBusy(i) > abstractNetwork->GetUplinkBusy(busiestUplink))
+            {
+                busiestUplink = i;
+            }
+            if (abstractNetwork->GetDownlinkBusy(i) >
+                abstractNetwork->GetDownlinkBusy(busiestDownlink))
+            {
+                busiestDownlink = i;
+            }
+        }
+        NS_LOG_INFO("Access links: mean queueing " << abstractNetwork->GetUplinkWait().GetMean() *
+                                                          1000.0
+                                                   << " ms up, "
+                                                   << abstractNetwork->GetDownlinkWait().GetMean() *
+                                                          1000.0
+                                                   << " ms down");
+        NS_LOG_INFO("Busiest uplink: node "
+                    << busiestUplink << " (" << p2pNodes[busiestUplink].GetPeers().size()
+                    << " peers) at "
+                    << abstractNetwork->GetUplinkBusy(busiestUplink).GetSeconds() / elapsed * 100.0
+                    << "% utilization; busiest downlink: node " << busiestDownlink << " at "
+                    << abstractNetwork->GetDownlinkBusy(busiestDownlink).GetSeconds() / elapsed *
+                           100.0
+                    << "% utilization");
     }
 };
 
+// Maps a scheduler name from the command line to its ns-3 TypeId
+TypeId SchedulerTypeFromName(const std::string& name)
+{
+    if (name == "map")
+    {
+        return MapScheduler::GetTypeId();
+    }
+    if (name == "heap")
+    {
+        return HeapScheduler::GetTypeId();
+    }
+    if (name == "list")
+    {
+        return ListScheduler::GetTypeId();
+    }
+    if (name == "calendar")
+    {
+        return CalendarScheduler::GetTypeId();
+    }
+    if (name == "priority")
+    {
+        return PriorityQueueScheduler::GetTypeId();
+    }
+    NS_FATAL_ERROR("Unknown scheduler '" << name
+                                         << "' (expected map, heap, list, calendar or priority)");
+}
+
+// Builds and runs one scenario from scratch with NodeT nodes, leaving the simulator reset
+template <typename NodeT>
+RunReport RunScenario(const ScenarioConfig& config)
+{
+    ObjectFactory schedulerFactory;
+    if (config.countEvents)
+    {
+        schedulerFactory.SetTypeId(CountingScheduler::GetTypeId());
+        schedulerFactory.Set("InnerType", TypeIdValue(SchedulerTypeFromName(config.scheduler)));
+        CountingScheduler::ResetCounters();
+    }
+    else
+    {
+        schedulerFactory.SetTypeId(SchedulerTypeFromName(config.scheduler));
+    }
+    Simulator::SetScheduler(schedulerFactory);
+
+    // Addresses are handed out again from the same bases on every run
+    Ipv4AddressGenerator::Reset();
+    RngSeedManager::SetSeed(config.seed);
+
+    P2PGossipNetworkSimulation<NodeT> sim(config);
+    sim.CreateRandomTopology(config.connectionProbability, config.latencyMs);
+    if (config.replications > 1)
+    {
+        return sim.RunEnsemble(config.replications, config.simulationTime);
+    }
+    return sim.Start(config.simulationTime);
+}
+
+// Picks the node codec named in the scenario
+template <typename Dedup, typename Forward>
+RunReport RunWithCodec(const ScenarioConfig& config)
+{
+    if (config.codec == "text")
+    {
+        return RunScenario<BasicP2PNode<Dedup, Forward, TextCodec>>(config);
+    }
+    if (config.codec == "binary")
+    {
+        return RunScenario<BasicP2PNode<Dedup, Forward, BinaryCodec>>(config);
+    }
+    NS_FATAL_ERROR("Unknown codec '" << config.codec << "' (expected text or binary)");
+}
+
+// Picks the node forward policy named in the scenario
+template <typename Dedup>
+RunReport RunWithForward(const ScenarioConfig& config)
+{
+    if (config.forward == "flood")
+    {
+        return RunWithCodec<Dedup, FloodForward>(config);
+    }
+    if (config.forward == "skipsender")
+    {
+        return RunWithCodec<Dedup, SkipSenderForward>(config);
+    }
+    if (config.forward == "kadcast")
+    {
+        return RunWithCodec<Dedup, KadcastForward>(config);
+    }
+    NS_FATAL_ERROR("Unknown forward policy '" << config.forward
+                                              << "' (expected flood, skipsender or kadcast)");
+}
+
+// Runs the scenario with the node policies it names; this is the only place
+// where the policy combination is chosen at runtime
+RunReport RunSelectedScenario(const ScenarioConfig& config)
+{
+    if (config.dedup == "hashset")
+    {
+        return RunWithForward<HashSetDedup>(config);
+    }
+    if (config.dedup == "flat")
+    {
+        return RunWithForward<FlatDedup>(config);
+    }
+    NS_FATAL_ERROR("Unknown dedup policy '" << config.dedup << "' (expected hashset or flat)");
+}
+
+// Runs the same seeded scenario on every scheduler backend and reports their throughput
+void RunSchedulerBenchmark(ScenarioConfig config)
+{
+    config.countEvents = true;
+    config.enableNetAnim = false;
+    config.printStats = false;
+
+    NS_LOG_INFO("=== Scheduler benchmark: " << config.numNodes << " nodes, " << config.simulationTime
+                                           << "s simulated, seed " << config.seed << " ===");
+    for (const char* name : {"map", "heap", "list", "calendar", "priority"})
+    {
+        config.scheduler = name;
+        RunReport report = RunSelectedScenario(config);
+        double eventsPerSec = report.wallSeconds > 0 ? report.events / report.wallSeconds : 0.0;
+        NS_LOG_INFO("Scheduler " << name << ": " << report.events << " events in "
+                                 << report.wallSeconds << "s wall, " << eventsPerSec
+                                 << " events/s, peak queue " << report.peakQueueSize
+                                 << ", shares sent " << report.sharesSent);
+    }
+}
+
+// Runs the same seeded scenario with every node policy combination, using the
+// default combination (the original hand-written behaviour) as the baseline
+void RunPolicyBenchmark(ScenarioConfig config)
+{
+    config.enableNetAnim = false;
+    config.printStats = false;
+
+    NS_LOG_INFO("=== Policy benchmark: " << config.numNodes << " nodes, " << config.simulationTime
+                                        << "s simulated, seed " << config.seed << " ===");
+    // Warm-up run so the first combination is not charged for cold caches and
+    // allocator growth. Times are relative to the default hashset/flood/text
+    // node; there is no separate non-template node to compare with.
+    RunSelectedScenario(config);
+
+    double defaultWall = 0.0;
+    for (const char* dedup : {"hashset", "flat"})
+    {
+        for (const char* forward : {"flood", "skipsender"})
+        {
+            for (const char* codec : {"text", "binary"})
+            {
+                config.dedup = dedup;
+                config.forward = forward;
+                config.codec = codec;
+                RunReport report = RunSelectedScenario(config);
+                if (defaultWall == 0.0)
+                {
+                    defaultWall = report.wallSeconds;
+                }
+                double nsPerShare =
+                    report.sharesSent > 0 ? report.wallSeconds * 1e9 / report.sharesSent : 0.0;
+                NS_LOG_INFO("Policies " << dedup << "/" << forward << "/" << codec << ": "
+                                        << report.wallSeconds << "s wall ("
+                                        << report.wallSeconds / defaultWall
+                                        << "x default), " << report.sharesSent
+                                        << " shares sent, " << nsPerShare << " ns/share");
+            }
+        }
+    }
+}
+
+// Runs the same seeded TCP scenario with every transport profile and compares
+// the first-receipt latency distribution
+void RunTcpProfileBenchmark(ScenarioConfig config)
+{
+    config.transport = "tcp";
+    config.enableNetAnim = false;
+    config.printStats = false;
+
+    NS_LOG_INFO("=== TCP profile benchmark: " << config.numNodes << " nodes, "
+                                             << config.simulationTime << "s simulated, seed "
+                                             << config.seed << " ===");
+    for (const char* profile : {"default", "nagle", "lowlatency", "bulk"})
+    {
+        config.tcpProfile = profile;
+        RunReport report = RunSelectedScenario(config);
+        NS_LOG_INFO("Profile " << profile << ": latency mean " << report.latencyMean * 1000.0
+                               << " ms, p50 " << report.latencyP50 * 1000.0 << " ms, p90 "
+                               << report.latencyP90 * 1000.0 << " ms, p99 "
+                               << report.latencyP99 * 1000.0 << " ms, shares sent "
+                               << report.sharesSent << ", " << report.wallSeconds << "s wall");
+    }
+}
+
+// Runs the same seeded scenario with proof of work on every supported SHA-256
+// kernel and a range of batch sizes, comparing the wall-clock cost of checking
+// a share. Batches fill from shares queued behind a busy core, or from shares
+// arriving in the same event when there is no service time. Each kernel first
+// hashes a set of known-answer headers and is flagged if its digests differ
+// from the scalar ones.
+void RunPowBenchmark(ScenarioConfig config)
+{
+    config.enableNetAnim = false;
+    config.printStats = false;
+    if (config.powBits == 0)
+    {
+        config.powBits = 8;
+    }
+
+    NS_LOG_INFO("=== Proof-of-work benchmark: " << config.numNodes << " nodes, "
+                                              << config.simulationTime << "s simulated, "
+                                              << config.powBits << " bits, seed " << config.seed
+                                              << " ===");
+    // Known-answer headers: the Bitcoin genesis header, whose digest is fixed,
+    // followed by random headers that span full vector passes and a remainder
+    static const uint8_t GENESIS_HEADER[SHA256_HEADER_SIZE] = {
+        0x01, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+        0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+        0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x3b, 0xa3, 0xed, 0xfd, 0x7a, 0x7b,
+        0x12, 0xb2, 0x7a, 0xc7, 0x2c, 0x3e, 0x67, 0x76, 0x8f, 0x61, 0x7f, 0xc8, 0x1b, 0xc3,
+        0x88, 0x8a, 0x51, 0x32, 0x3a, 0x9f, 0xb8, 0xaa, 0x4b, 0x1e, 0x5e, 0x4a, 0x29, 0xab,
+        0x5f, 0x49, 0xff, 0xff, 0x00, 0x1d, 0x1d, 0xac, 0x2b, 0x7c};
+    static const uint8_t GENESIS_DIGEST[SHA256_DIGEST_SIZE] = {
+        0x6f, 0xe2, 0x8c, 0x0a, 0xb6, 0xf1, 0xb3, 0x72, 0xc1, 0xa6, 0xa2,
+        0x46, 0xae, 0x63, 0xf7, 0x4f, 0x93, 0x1e, 0x83, 0x65, 0xe1, 0x5a,
+        0x08, 0x9c, 0x68, 0xd6, 0x19, 0x00, 0x00, 0x00, 0x00, 0x00};
+    size_t checkCount = 8 * 4 + 3;
+    std::vector<uint8_t> checkHeaders(checkCount * SHA256_HEADER_SIZE);
+    Pcg32 rng(config.seed, 0x5a256);
+    for (uint8_t& byte : checkHeaders)
+    {
+        byte = static_cast<uint8_t>(rng());
+    }
+    std::copy(GENESIS_HEADER, GENESIS_HEADER + SHA256_HEADER_SIZE, checkHeaders.begin());
+    std::vector<uint8_t> scalarDigests(checkCount * SHA256_DIGEST_SIZE);
+    Sha256dHeaders(Sha256Kernel::Scalar, checkHeaders.data(), checkCount, scalarDigests.data());
+    for (Sha256Kernel kernel : {Sha256Kernel::Scalar, Sha256Kernel::Sse41, Sha256Kernel::Avx2})
+    {
+        if (!Sha256KernelSupported(kernel))
+        {
+            continue;
+        }
+        std::vector<uint8_t> digests(checkCount * SHA256_DIGEST_SIZE);
+        Sha256dHeaders(kernel, checkHeaders.data(), checkCount, digests.data());
+        bool correct = digests == scalarDigests &&
+                       std::equal(GENESIS_DIGEST, GENESIS_DIGEST + SHA256_DIGEST_SIZE,
+                                  digests.begin());
+        config.sha256Kernel = Sha256KernelName(kernel);
+        uint32_t lanes = Sha256KernelLanes(kernel);
+        std::vector<uint32_t> batchSizes = {1};
+        for (uint32_t batch : {lanes, lanes * 4})
+        {
+            if (batch > batchSizes.back())
+            {
+                batchSizes.push_back(batch);
+            }
+        }
+        for (uint32_t batch : batchSizes)
+        {
+            config.powBatch = batch;
+            RunReport report = RunSelectedScenario(config);
+            NS_LOG_INFO("Kernel " << config.sha256Kernel << ", batch " << batch << ": "
+                                  << report.powNsPerShare << " ns/share, mean batch "
+                                  << report.powMeanBatch << ", latency mean "
+                                  << report.latencyMean * 1000.0 << " ms, "
+                                  << report.wallSeconds << "s wall"
+                                  << (correct ? "" : ", DIGEST MISMATCH"));
+        }
+    }
+}
+
+// Runs the same seeded scenario with each (topology, forward policy) variant
+// and compares message cost, latency tails and coverage
+void RunTopologyComparison(ScenarioConfig config,
+                           const std::string& title,
+                           const std::vector<std::pair<std::string, std::string>>& variants)
+{
+    config.enableNetAnim = false;
+    config.printStats = false;
+
+    NS_LOG_INFO("=== " << title << " benchmark: " << config.numNodes << " nodes, "
+                       << config.simulationTime << "s simulated, seed " << config.seed
+                       << " ===");
+    for (const auto& variant : variants)
+    {
+        config.topology = variant.first;
+        config.forward = variant.second;
+        RunReport report = RunSelectedScenario(config);
+        double messagesPerShare =
+            report.sharesGenerated > 0
+                ? static_cast<double>(report.sharesSent) / report.sharesGenerated
+                : 0.0;
+        NS_LOG_INFO("Topology " << variant.first << "/" << variant.second << ": "
+                                << messagesPerShare << " messages per share, latency mean "
+                                << report.latencyMean * 1000.0 << " ms, p90 "
+                                << report.latencyP90 * 1000.0 << " ms, p99 "
+                                << report.latencyP99 * 1000.0 << " ms, coverage "
+                                << report.coverage << ", stale rate " << report.staleRate
+                                << ", " << report.wallSeconds << "s wall");
+    }
+}
+
+// Runs the same seeded sharechain scenario at increasing link latencies and
+// reports how the stale share and fork rates grow with propagation delay
+void RunShareChainBenchmark(ScenarioConfig config)
+{
+    config.enableNetAnim = false;
+    config.printStats = false;
+    config.shareChain = true;
+
+    NS_LOG_INFO("=== Sharechain benchmark: " << config.numNodes << " nodes, "
+                                           << config.simulationTime << "s simulated, seed "
+                                           << config.seed << " ===");
+    double baseLatencyMs = config.latencyMs;
+    for (double scale : {1.0, 2.0, 4.0, 8.0, 16.0})
+    {
+        config.latencyMs = baseLatencyMs * scale;
+        RunReport report = RunSelectedScenario(config);
+        NS_LOG_INFO("Link latency " << config.latencyMs << " ms: propagation latency mean "
+                                    << report.latencyMean * 1000.0 << " ms, p90 "
+                                    << report.latencyP90 * 1000.0 << " ms, stale rate "
+                                    << report.staleRate << ", forks per share "
+                                    << report.forkRate << ", " << report.wallSeconds
+                                    << "s wall");
+    }
+}
+
+// Prepares a benchmark with share payloads: abstract transport, 100 Mbps
+// uplinks unless set, and, unless mining is configured, one share per 10 s
+// network-wide, since megabyte shares flooded at the interval model's rate
+// would saturate every uplink
+void ConfigurePayloadBenchmark(ScenarioConfig& config)
+{
+    config.enableNetAnim = false;
+    config.printStats = false;
+    config.transport = "abstract";
+    if (config.uplinkMbps <= 0)
+    {
+        config.uplinkMbps = 100.0;
+    }
+    if (config.hashrate.empty() && config.hashrateFile.empty())
+    {
+        config.hashrate = "equal";
+        config.difficulty = config.numNodes * config.hashrateMean * 10.0 / HASHES_PER_DIFFICULTY;
+    }
+}
+
+// Runs the same seeded scenario with share payloads from 100 KB to 1 MB, each
+// sent as one message, in chunks relayed store-and-forward and in chunks
+// relayed cut-through, and compares the end-to-end latency of whole shares
+void RunChunkingBenchmark(ScenarioConfig config)
+{
+    ConfigurePayloadBenchmark(config);
+    uint32_t chunkBytes = config.chunkBytes > 0 ? config.chunkBytes : 16384;
+
+    NS_LOG_INFO("=== Chunking benchmark: " << config.numNodes << " nodes, "
+                                          << config.simulationTime << "s simulated, "
+                                          << config.uplinkMbps << " Mbps uplinks, "
+                                          << chunkBytes << " byte chunks, seed " << config.seed
+                                          << " ===");
+    for (uint32_t payload : {100000u, 250000u, 500000u, 1000000u})
+    {
+        config.payloadBytes = payload;
+        double wholeLatency = 0.0;
+        for (const char* mode : {"whole", "chunked", "cutthrough"})
+        {
+            config.chunkBytes = std::string(mode) == "whole" ? 0 : chunkBytes;
+            config.cutThrough = std::string(mode) == "cutthrough";
+            RunReport report = RunSelectedScenario(config);
+            if (wholeLatency == 0.0)
+            {
+                wholeLatency = report.latencyMean;
+            }
+            NS_LOG_INFO("Payload " << payload / 1000 << " KB, " << mode << ": latency mean "
+                                   << report.latencyMean * 1000.0 << " ms ("
+                                   << (report.latencyMean > 0 ? wholeLatency / report.latencyMean
+                                                              : 0.0)
+                                   << "x faster than whole), p90 "
+                                   << report.latencyP90 * 1000.0 << " ms, p99 "
+                                   << report.latencyP99 * 1000.0 << " ms, coverage "
+                                   << report.coverage << ", " << report.wallSeconds
+                                   << "s wall");
+        }
+    }
+}
+
+// Runs the same seeded scenario relaying full payloads and then compact
+// announcements at decreasing pool overlap, and reports the bytes saved, the
+// component round trips added and what both do to propagation latency
+void RunCompactRelayBenchmark(ScenarioConfig config)
+{
+    ConfigurePayloadBenchmark(config);
+    if (config.payloadBytes == 0)
+    {
+        config.payloadBytes = 1000000;
+    }
+    config.chunkBytes = 0;
+
+    NS_LOG_INFO("=== Compact relay benchmark: " << config.numNodes << " nodes, "
+                                               << config.simulationTime << "s simulated, "
+                                               << config.payloadBytes << " byte payloads of "
+                                               << config.components << " components, seed "
+                                               << config.seed << " ===");
+    config.compactRelay = false;
+    RunReport full = RunSelectedScenario(config);
+    NS_LOG_INFO("Full payloads: latency mean " << full.latencyMean * 1000.0 << " ms, p90 "
+                                               << full.latencyP90 * 1000.0 << " ms");
+    config.compactRelay = true;
+    for (double overlap : {1.0, 0.99, 0.95, 0.8, 0.5})
+    {
+        config.poolOverlap = overlap;
+        RunReport report = RunSelectedScenario(config);
+        NS_LOG_INFO("Compact, pool overlap " << overlap << ": " << report.compactSavings * 100.0
+                                             << "% bytes saved, "
+                                             << report.roundTripsPerShare
+                                             << " round trips per share, latency mean "
+                                             << report.latencyMean * 1000.0 << " ms, p90 "
+                                             << report.latencyP90 * 1000.0 << " ms, "
+                                             << report.wallSeconds << "s wall");
+    }
+}
+
+// Decodes one payload of the configured size from random combinations with
+// every supported GF(2^8) kernel and prints the decode throughput, then runs
+// the same seeded scenario with chunks relayed store-and-forward, relayed
+// cut-through and coded, and compares share completion time and bytes sent
+void RunNetworkCodingBenchmark(ScenarioConfig config)
+{
+    ConfigurePayloadBenchmark(config);
+    if (config.payloadBytes == 0)
+    {
+        config.payloadBytes = 1000000;
+    }
+    if (config.chunkBytes == 0)
+    {
+        config.chunkBytes = 16384;
+    }
+    uint32_t chunks = (config.payloadBytes + config.chunkBytes - 1) / config.chunkBytes;
+
+    NS_LOG_INFO("=== Network coding benchmark: " << config.numNodes << " nodes, "
+                                                << config.simulationTime << "s simulated, "
+                                                << config.payloadBytes << " byte payloads in "
+                                                << chunks << " chunks, seed " << config.seed
+                                                << " ===");
+    Pcg32 rng(config.seed, 0xc0de);
+    std::vector<uint8_t> payload(static_cast<size_t>(chunks) * config.chunkBytes);
+    for (uint8_t& byte : payload)
+    {
+        byte = static_cast<uint8_t>(rng());
+    }
+    for (Gf256Kernel kernel : {Gf256Kernel::Scalar, Gf256Kernel::Ssse3, Gf256Kernel::Avx2})
+    {
+        if (!Gf256KernelSupported(kernel))
+        {
+            continue;
+        }
+        // Packets are encoded up front so only decoding is timed
+        std::vector<std::vector<uint8_t>> packets;
+        RlncDecoder check(chunks, 0, kernel);
+        while (!check.IsComplete())
+        {
+            std::vector<uint8_t> packet(chunks + config.chunkBytes, 0);
+            RlncDecoder::RandomCoefficients(rng, chunks, packet.data());
+            for (uint32_t i = 0; i < chunks; i++)
+            {
+                Gf256MulAdd(kernel, packet.data() + chunks,
+                            &payload[static_cast<size_t>(i) * config.chunkBytes], packet[i],
+                            config.chunkBytes);
+            }
+            check.Add(packet.data());
+            packets.push_back(std::move(packet));
+        }
+        auto start = std::chrono::steady_clock::now();
+        RlncDecoder decoder(chunks, config.chunkBytes, kernel);
+        for (const std::vector<uint8_t>& packet : packets)
+        {
+            decoder.Add(packet.data());
+        }
+        std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+        bool correct = true;
+        for (uint32_t i = 0; i < chunks; i++)
+        {
+            correct = correct && std::equal(decoder.GetChunk(i),
+                                            decoder.GetChunk(i) + config.chunkBytes,
+                                            &payload[static_cast<size_t>(i) * config.chunkBytes]);
+        }
+        NS_LOG_INFO("Kernel " << Gf256KernelName(kernel) << ": decoded " << packets.size()
+                              << " packets in " << elapsed.count() * 1000.0 << " ms ("
+                              << payload.size() / elapsed.count() / 1e6 << " MB/s)"
+                              << (correct ? "" : ", DECODE MISMATCH"));
+    }
+
+    double chunkedLatency = 0.0;
+    double chunkedBytes = 0.0;
+    for (const char* mode : {"chunked", "cutthrough", "coded"})
+    {
+        config.cutThrough = std::string(mode) != "chunked";
+        config.networkCoding = std::string(mode) == "coded";
+        RunReport report = RunSelectedScenario(config);
+        if (chunkedLatency == 0.0)
+        {
+            chunkedLatency = report.latencyMean;
+            chunkedBytes = report.bytesPerShare;
+        }
+        NS_LOG_INFO(mode << ": completion mean " << report.latencyMean * 1000.0 << " ms ("
+                         << (report.latencyMean > 0 ? chunkedLatency / report.latencyMean : 0.0)
+                         << "x faster than chunked), p90 " << report.latencyP90 * 1000.0
+                         << " ms, coverage " << report.coverage << ", "
+                         << report.bytesPerShare / 1e6 << " MB sent per share per node ("
+                         << (chunkedBytes > 0 ? report.bytesPerShare / chunkedBytes : 0.0)
+                         << "x chunked), " << report.wallSeconds << "s wall");
+    }
+}
+
+// Runs the same seeded scenario with Pareto-skewed generation rates and
+// uplinks served in FIFO order, by deficit round robin across producers, and
+// by round robin with per-producer token buckets, and compares how the
+// largest producer's shares and everyone else's propagate
+void RunFairnessBenchmark(ScenarioConfig config)
+{
+    if (config.hashrate.empty() && config.hashrateFile.empty())
+    {
+        config.hashrate = "pareto";
+    }
+    ConfigurePayloadBenchmark(config);
+    if (config.payloadBytes == 0)
+    {
+        config.payloadBytes = 50000;
+    }
+    double peerRateMbps = config.peerRateMbps > 0 ? config.peerRateMbps : config.uplinkMbps / 4;
+
+    NS_LOG_INFO("=== Fairness benchmark: " << config.numNodes << " nodes, "
+                                          << config.simulationTime << "s simulated, "
+                                          << config.payloadBytes << " byte payloads, "
+                                          << config.uplinkMbps << " Mbps uplinks, seed "
+                                          << config.seed << " ===");
+    for (const char* mode : {"fifo", "drr", "drr+bucket"})
+    {
+        config.uplinkScheduler = std::string(mode) == "fifo" ? "fifo" : "drr";
+        config.peerRateMbps = std::string(mode) == "drr+bucket" ? peerRateMbps : 0.0;
+        RunReport report = RunSelectedScenario(config);
+        NS_LOG_INFO(mode << ": latency mean " << report.latencyMean * 1000.0 << " ms, p90 "
+                         << report.latencyP90 * 1000.0 << " ms, largest producer "
+                         << report.topProducerLatency * 1000.0 << " ms, others "
+                         << report.otherLatency * 1000.0 << " ms, Jain's index "
+                         << report.latencyFairness << ", coverage " << report.coverage << ", "
+                         << report.wallSeconds << "s wall");
+    }
+}
+
+// Runs the same seeded scenario at increasing overlay degree, once flooding
+// to every peer and once reconciling beyond the first floodPeers, and
+// compares the bytes each node sends per share with propagation latency
+void RunReconciliationBenchmark(ScenarioConfig config)
+{
+    config.enableNetAnim = false;
+    config.printStats = false;
+    config.transport = "abstract";
+
+    NS_LOG_INFO("=== Reconciliation benchmark: " << config.numNodes << " nodes, "
+                                                << config.simulationTime << "s simulated, "
+                                                << config.floodPeers << " flood peers, "
+                                                << config.reconIntervalMs << " ms interval, "
+                                                << config.forward << " forwarding, seed "
+                                                << config.seed << " ===");
+    double fullMesh = config.numNodes - 1;
+    for (double degree : {8.0, 16.0, 32.0, 64.0})
+    {
+        // A network smaller than the target is a full mesh at every larger target too
+        if (degree > 8.0 && config.connectionProbability >= 1.0)
+        {
+            break;
+        }
+        config.connectionProbability = std::min(1.0, degree / fullMesh);
+        for (bool reconcile : {false, true})
+        {
+            config.reconciliation = reconcile;
+            RunReport report = RunSelectedScenario(config);
+            NS_LOG_INFO("Degree " << degree << " (mean " << report.meanDegree << "), "
+                                  << (reconcile ? "reconcile" : "flood") << ": "
+                                  << report.bytesPerShare
+                                  << " bytes per share per node, latency mean "
+                                  << report.latencyMean * 1000.0 << " ms, p90 "
+                                  << report.latencyP90 * 1000.0 << " ms, coverage "
+                                  << report.coverage << ", " << report.wallSeconds << "s wall");
+        }
+    }
+}
+
 // Entry point for the simulation program
 int main(int argc, char* argv[])
     {
-        LogComponentEnable("P2PGossipNetworkSimulation", LOG_LEVEL_INFO);
-        LogComponentEnable("P2PNode", LOG_LEVEL_INFO);
-
-        uint32_t numNodes = 10;
-        double connectionProbability = 0.3;
-        double simulationTime = 60.0;
-        double LatencyMs = 5.0;
+        ScenarioConfig config;
+        std::string benchmark;
 
         CommandLine cmd;
-        cmd.AddValue("numNodes", "Number of nodes", numNodes);
+        cmd.AddValue("numNodes", "Number of nodes", config.numNodes);
         cmd.AddValue("connectionProb",
                         "Probability of connection between nodes",
-                        connectionProbability);
-        cmd.AddValue("simTime", "Simulation time in seconds", simulationTime);
-        cmd.AddValue("Latency", "latency in ms", LatencyMs);
+                        config.connectionProbability);
+        cmd.AddValue("simTime", "Simulation time in seconds", config.simulationTime);
+        cmd.AddValue("Latency", "latency in ms", config.latencyMs);
+        cmd.AddValue("uplinkMbps",
+                        "Per-node uplink capacity shared by all its peers (0 = 5Mbps per peer link)",
+                        config.uplinkMbps);
+        cmd.AddValue("downlinkMbps",
+                        "Per-node downlink capacity (0 = same as uplink)",
+                        config.downlinkMbps);
+        cmd.AddValue("uplinkScheduler",
+                        "Uplink scheduling over the abstract transport: fifo, or drr across "
+                        "producers",
+                        config.uplinkScheduler);
+        cmd.AddValue("drrQuantum",
+                        "Bytes a producer's queue may send per deficit round robin turn",
+                        config.drrQuantum);
+        cmd.AddValue("peerRateMbps",
+                        "Token bucket rate capping each producer's uplink queue (0 = no cap)",
+                        config.peerRateMbps);
+        cmd.AddValue("peerBurst",
+                        "Token bucket size in bytes of each producer's uplink queue",
+                        config.peerBurstBytes);
+        cmd.AddValue("payloadBytes",
+                        "Payload carried by every share (abstract transport with access links)",
+                        config.payloadBytes);
+        cmd.AddValue("chunkBytes",
+                        "Chunk size share payloads are split into (0 = one message)",
+                        config.chunkBytes);
+        cmd.AddValue("cutThrough",
+                        "Relay each payload chunk as soon as it arrives",
+                        config.cutThrough);
+        cmd.AddValue("networkCoding",
+                        "Send payload chunks as random linear combinations over GF(2^8)",
+                        config.networkCoding);
+        cmd.AddValue("gf256Kernel",
+                        "GF(2^8) kernel for network coding: auto, scalar, ssse3 or avx2",
+                        config.gf256Kernel);
+        cmd.AddValue("compactRelay",
+                        "Announce share payloads as short component IDs and request only "
+                        "missing components",
+                        config.compactRelay);
+        cmd.AddValue("components",
+                        "Components a share payload consists of for compact relay",
+                        config.components);
+        cmd.AddValue("poolOverlap",
+                        "Probability that a receiver already holds a payload component",
+                        config.poolOverlap);
+        cmd.AddValue("reconciliation",
+                        "Flood shares to the first floodPeers peers and reconcile with the rest "
+                        "(abstract transport)",
+                        config.reconciliation);
+        cmd.AddValue("floodPeers",
+                        "Peers a node floods shares to when reconciling",
+                        config.floodPeers);
+        cmd.AddValue("reconInterval",
+                        "Time in ms between reconciliation rounds on a link",
+                        config.reconIntervalMs);
+        cmd.AddValue("serviceTime",
+                        "Mean CPU time in ms to validate a received share before forwarding (0 = none)",
+                        config.serviceTimeMs);
+        cmd.AddValue("cpuCores", "Cores validating shares in parallel on each node", config.cpuCores);
+        cmd.AddValue("serviceDistribution",
+                        "Validation time distribution: constant or exponential",
+                        config.serviceDistribution);
+        cmd.AddValue("powBits",
+                        "Proof of work: leading zero bits of a share's double SHA-256 (0 = off)",
+                        config.powBits);
+        cmd.AddValue("powBatch",
+                        "Shares whose proofs are checked in one SHA-256 batch (0 = kernel lanes)",
+                        config.powBatch);
+        cmd.AddValue("sha256Kernel",
+                        "SHA-256 kernel for proofs: auto, scalar, sse41 or avx2",
+                        config.sha256Kernel);
+        cmd.AddValue("shareChain",
+                        "Build shares into a sharechain and report stale shares and forks",
+                        config.shareChain);
+        cmd.AddValue("confirmations",
+                        "Shares below the best tip before a share counts as settled",
+                        config.confirmations);
+        cmd.AddValue("fetchTimeout",
+                        "Milliseconds a node waits for a requested parent share before asking "
+                        "another peer",
+                        config.fetchTimeoutMs);
+        cmd.AddValue("fetchAttempts",
+                        "Peers asked for a missing parent share before its orphans are dropped",
+                        config.fetchAttempts);
+        cmd.AddValue("hashrate",
+                        "Hashrate-weighted mining with node hashrates drawn as equal, exponential "
+                        "or pareto (empty = uniform share intervals)",
+                        config.hashrate);
+        cmd.AddValue("hashrateFile",
+                        "File with one hashrate in H/s per node, in node order",
+                        config.hashrateFile);
+        cmd.AddValue("hashrateMean", "Mean drawn hashrate in H/s", config.hashrateMean);
+        cmd.AddValue("hashrateShape",
+                        "Shape of the pareto hashrate distribution (> 1)",
+                        config.hashrateShape);
+        cmd.AddValue("difficulty",
+                        "Share difficulty; a share takes difficulty * 2^32 hashes on average "
+                        "(0 = keep the network share rate of the interval model)",
+                        config.difficulty);
+        cmd.AddValue("nodeClasses",
+                        "File of node classes (name fraction minInterval maxInterval uplinkMbps "
+                        "downlinkMbps targetDegree serviceTimeMs per line)",
+                        config.nodeClassFile);
+        cmd.AddValue("topology",
+                        "Overlay shape: flat, hierarchical (clusters with relays) or kadcast "
+                        "(k-buckets with delegated broadcast)",
+                        config.topology);
+        cmd.AddValue("clusterSize", "Nodes per cluster in a hierarchical overlay", config.clusterSize);
+        cmd.AddValue("relaysPerCluster",
+                        "Relays elected per cluster in a hierarchical overlay",
+                        config.relaysPerCluster);
+        cmd.AddValue("relayDegree",
+                        "Expected links from each relay to relays of other clusters",
+                        config.relayDegree);
+        cmd.AddValue("kadcastK",
+                        "Peers each node picks per k-bucket in a kadcast overlay",
+                        config.kadcastK);
+        cmd.AddValue("seed", "Seed for topology and share generation (0 = random)", config.seed);
+        cmd.AddValue("transport",
+                        "Share transport: tcp (ns-3 TCP/IP stack) or abstract (direct delivery)",
+                        config.transport);
+        cmd.AddValue("scheduler",
+                        "Event scheduler: map, heap, list, calendar or priority",
+                        config.scheduler);
+        cmd.AddValue("dedup", "Dedup policy: hashset or flat", config.dedup);
+        cmd.AddValue("forward", "Forward policy: flood, skipsender or kadcast", config.forward);
+        cmd.AddValue("codec", "Share wire format: text or binary", config.codec);
+        cmd.AddValue("tcpProfile",
+                        "TCP settings for overlay connections: default, nagle, lowlatency or bulk",
+                        config.tcpProfile);
+        cmd.AddValue("centralGeneration",
+                        "Drive share generation from one central event instead of per-node timers",
+                        config.centralGeneration);
+        cmd.AddValue("replications",
+                        "Replications run on one topology with different generation seeds",
+                        config.replications);
+        cmd.AddValue("drainTime",
+                        "Seconds in-flight shares may drain between replications",
+                        config.drainTime);
+        cmd.AddValue("bootstrapConcurrency",
+                        "Connection handshakes in flight at once during bootstrap (0 = all)",
+                        config.bootstrapConcurrency);
+        cmd.AddValue("bootstrapJitter",
+                        "Maximum random delay in ms before each bootstrap connection starts",
+                        config.bootstrapJitterMs);
+        cmd.AddValue("precision",
+                        "Stop once latency and coverage CIs reach this relative half-width (0 = off)",
+                        config.relativePrecision);
+        cmd.AddValue("batchTime", "Seconds per batch for the stopping rule", config.batchTime);
+        cmd.AddValue("minBatches",
+                        "Batches after warm-up required before the run may stop",
+                        config.minBatches);
+        cmd.AddValue("coverageHorizon",
+                        "Seconds after creation at which a share's coverage is fixed",
+                        config.coverageHorizon);
+        cmd.AddValue("benchmark",
+                        "Benchmark mode instead of a single run: schedulers, policies, tcpprofiles, "
+                        "hierarchy, kadcast, pow, sharechain, chunking, compact, coding, "
+                        "reconciliation or fairness",
+                        benchmark);
         cmd.Parse(argc, argv);
 
-        P2PGossipNetworkSimulation sim(numNodes);
-        sim.CreateRandomTopology(connectionProbability, LatencyMs);
-        sim.Start(simulationTime);
+        LogComponentEnable("P2PGossipNetworkSimulation", LOG_LEVEL_INFO);
+        if (benchmark.empty())
+        {
+            LogComponentEnable("P2PNode", LOG_LEVEL_INFO);
+            LogComponentEnable("ConnectionBootstrap", LOG_LEVEL_INFO);
+        }
+
+        if (config.topology != "flat" && config.topology != "hierarchical" &&
+            config.topology != "kadcast")
+        {
+            NS_FATAL_ERROR("Unknown topology '" << config.topology << "'");
+        }
+        // Kadcast forwarding only reaches every node over k-bucket peer tables
+        if (config.topology == "kadcast")
+        {
+            config.forward = "kadcast";
+        }
+        else if (config.forward == "kadcast")
+        {
+            NS_FATAL_ERROR("The kadcast forward policy needs --topology=kadcast");
+        }
+        if (config.serviceDistribution != "constant" &&
+            config.serviceDistribution != "exponential")
+        {
+            NS_FATAL_ERROR("Unknown service distribution '" << config.serviceDistribution << "'");
+        }
+        if (config.cpuCores < 1)
+        {
+            NS_FATAL_ERROR("Nodes need at least one CPU core");
+        }
+        if (config.fetchTimeoutMs <= 0.0 || config.fetchAttempts < 1)
+        {
+            NS_FATAL_ERROR("Parent fetches need a positive fetchTimeout and fetchAttempts >= 1");
+        }
+        Sha256Kernel kernel;
+        if (!Sha256KernelFromName(config.sha256Kernel, kernel))
+        {
+            NS_FATAL_ERROR("Unknown SHA-256 kernel '" << config.sha256Kernel << "'");
+        }
+        if (!Sha256KernelSupported(kernel))
+        {
+            NS_FATAL_ERROR("This CPU does not support the " << config.sha256Kernel
+                                                            << " SHA-256 kernel");
+        }
+        if (config.uplinkScheduler != "fifo" && config.uplinkScheduler != "drr")
+        {
+            NS_FATAL_ERROR("Unknown uplink scheduler '" << config.uplinkScheduler << "'");
+        }
+        if ((config.uplinkScheduler == "drr" || config.peerRateMbps > 0) &&
+            (config.uplinkScheduler != "drr" || config.transport != "abstract" ||
+             (config.uplinkMbps <= 0 && config.nodeClassFile.empty()) || config.drrQuantum < 1 ||
+             config.peerBurstBytes < 1 || config.peerRateMbps < 0))
+        {
+            NS_FATAL_ERROR("Fair queueing needs --uplinkScheduler=drr, --transport=abstract, "
+                           "access links, drrQuantum >= 1 and peerBurst >= 1");
+        }
+        Gf256Kernel gf256Kernel;
+        if (!Gf256KernelFromName(config.gf256Kernel, gf256Kernel))
+        {
+            NS_FATAL_ERROR("Unknown GF(2^8) kernel '" << config.gf256Kernel << "'");
+        }
+        if (!Gf256KernelSupported(gf256Kernel))
+        {
+            NS_FATAL_ERROR("This CPU does not support the " << config.gf256Kernel
+                                                            << " GF(2^8) kernel");
+        }
+        if (config.networkCoding &&
+            (config.chunkBytes == 0 || config.chunkBytes >= config.payloadBytes ||
+             config.compactRelay ||
+             (config.payloadBytes + config.chunkBytes - 1) / config.chunkBytes > MAX_CODED_CHUNKS))
+        {
+            NS_FATAL_ERROR("Network coding needs a payload split into 2 to " << MAX_CODED_CHUNKS
+                                                                           << " chunks and no "
+                                                                              "compact relay");
+        }
+        if (config.powBits > MAX_POW_TARGET_BITS)
+        {
+            NS_FATAL_ERROR("powBits is limited to " << MAX_POW_TARGET_BITS);
+        }
+        if (config.hashrate != "" && config.hashrate != "equal" &&
+            config.hashrate != "exponential" && config.hashrate != "pareto")
+        {
+            NS_FATAL_ERROR("Unknown hashrate distribution '" << config.hashrate << "'");
+        }
+        if (config.hashrateMean <= 0 || config.hashrateShape <= 1 || config.difficulty < 0)
+        {
+            NS_FATAL_ERROR("Hashrates need a positive mean, a pareto shape above 1 and a "
+                           "non-negative difficulty");
+        }
+        if (config.kadcastK < 1)
+        {
+            NS_FATAL_ERROR("A kadcast overlay needs kadcastK >= 1");
+        }
+        if (config.clusterSize < 2 || config.relaysPerCluster < 1 ||
+            config.relaysPerCluster > config.clusterSize)
+        {
+            NS_FATAL_ERROR("A cluster needs at least 2 nodes and between 1 and clusterSize relays");
+        }
+        if (config.transport != "tcp" && config.transport != "abstract")
+        {
+            NS_FATAL_ERROR("Unknown transport '" << config.transport << "'");
+        }
+        if (config.payloadBytes > 0 &&
+            (config.transport != "abstract" ||
+             (config.uplinkMbps <= 0 && config.nodeClassFile.empty())))
+        {
+            NS_FATAL_ERROR("Share payloads need --transport=abstract and access links "
+                           "(--uplinkMbps or per-class uplinks); TCP frames carry only the "
+                           "share header");
+        }
+        if (config.compactRelay &&
+            (config.payloadBytes == 0 || config.chunkBytes > 0 || config.components < 1 ||
+             config.poolOverlap < 0 || config.poolOverlap > 1))
+        {
+            NS_FATAL_ERROR("Compact relay needs a payload without chunking, components >= 1 and "
+                           "a poolOverlap between 0 and 1");
+        }
+        if (config.reconciliation &&
+            (config.transport != "abstract" || config.payloadBytes > 0 || config.compactRelay ||
+             config.reconIntervalMs <= 0))
+        {
+            NS_FATAL_ERROR("Reconciliation needs --transport=abstract without payloads or compact "
+                           "relay and a positive reconInterval; TCP frames have no encoding for "
+                           "sketches");
+        }
+        if (config.relativePrecision > 0 && (config.batchTime <= 0 || config.minBatches < 2))
+        {
+            NS_FATAL_ERROR("The stopping rule needs a positive batchTime and minBatches >= 2");
+        }
+        if (config.seed == 0)
+        {
+            std::random_device rd;
+            config.seed = rd();
+        }
+        NS_LOG_INFO("Using seed " << config.seed);
+
+        if (benchmark == "schedulers")
+        {
+            RunSchedulerBenchmark(config);
+        }
+        else if (benchmark == "policies")
+        {
+            RunPolicyBenchmark(config);
+        }
+        else if (benchmark == "hierarchy")
+        {
+            RunTopologyComparison(config,
+                                  "Hierarchy",
+                                  {{"flat", config.forward}, {"hierarchical", config.forward}});
+        }
+        else if (benchmark == "kadcast")
+        {
+            RunTopologyComparison(config, "Kadcast", {{"flat", "flood"}, {"kadcast", "kadcast"}});
+        }
+        else if (benchmark == "tcpprofiles")
+        {
+            RunTcpProfileBenchmark(config);
+        }
+        else if (benchmark == "pow")
+        {
+            RunPowBenchmark(config);
+        }
+        else if (benchmark == "sharechain")
+        {
+            RunShareChainBenchmark(config);
+        }
+        else if (benchmark == "chunking")
+        {
+            RunChunkingBenchmark(config);
+        }
+        else if (benchmark == "compact")
+        {
+            RunCompactRelayBenchmark(config);
+        }
+        else if (benchmark == "fairness")
+        {
+            RunFairnessBenchmark(config);
+        }
+        else if (benchmark == "coding")
+        {
+            RunNetworkCodingBenchmark(config);
+        }
+        else if (benchmark == "reconciliation")
+        {
+            RunReconciliationBenchmark(config);
+        }
+        else if (!benchmark.empty())
+        {
+            NS_FATAL_ERROR("Unknown benchmark '" << benchmark << "'");
+        }
+        else
+        {
+            RunSelectedScenario(config);
+        }
 
         return 0;
-    }
\ No newline at end of file
+    }
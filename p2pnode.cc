@@ -1,4 +1,10 @@
 #include "p2pnode.h"
+
+#include "abstractnetwork.h"
+#include "gossipmetrics.h"
+#include "processingmodel.h"
+#include "sharechain.h"
+
 #include <sstream>
 
 NS_LOG_COMPONENT_DEFINE("P2PNode");
@@ -6,17 +12,22 @@ NS_LOG_COMPONENT_DEFINE("P2PNode");
 std::string Share::ToString() const
 {
     std::stringstream ss;
-    ss << "SHARE:" << originNodeId << ":" << shareId << ":" << timestamp;
+    ss << "SHARE:" << originNodeId << ":" << shareId << ":" << timestamp << ":" << nonce << ":"
+       << parent;
     return ss.str();
 }
 
 Share Share::FromString(const std::string& str)
 {
     Share share;
+    share.nonce = 0;
+    share.parent = NO_PARENT;
 
     size_t firstColon = str.find(":");
     size_t secondColon = str.find(":", firstColon + 1);
     size_t thirdColon = str.find(":", secondColon + 1);
+    size_t fourthColon = str.find(":", thirdColon + 1);
+    size_t fifthColon = str.find(":", fourthColon + 1);
 
     if (firstColon != std::string::npos && secondColon != std::string::npos &&
         thirdColon != std::string::npos)
@@ -25,90 +36,319 @@ Share Share::FromString(const std::string& str)
             std::stoul(str.substr(firstColon + 1, secondColon - firstColon - 1));
         share.shareId = std::stoul(str.substr(secondColon + 1, thirdColon - secondColon - 1));
         share.timestamp = std::stod(str.substr(thirdColon + 1));
+        if (fourthColon != std::string::npos)
+        {
+            share.nonce = std::stoul(str.substr(fourthColon + 1));
+        }
+        if (fourthColon != std::string::npos && fifthColon != std::string::npos)
+        {
+            share.parent = std::stoul(str.substr(fifthColon + 1));
+        }
     }
 
     return share;
 }
 
-P2PNode::P2PNode(uint32_t id)
+// Messages on a TCP connection are framed with a 4-byte big-endian length
+// prefix, since the stream may split or merge them arbitrarily.
+static const size_t FRAME_HEADER_SIZE = 4;
+
+// IPv4 and TCP headers carried by every frame; counted when abstract links
+// serialize shares onto access links
+static const size_t IP_TCP_HEADER_SIZE = 40;
+
+// Wraps an encoded message body (which starts after a reserved header) into a packet
+static Ptr<Packet> MakeFrame(std::string& frame)
+{
+    uint32_t length = frame.size() - FRAME_HEADER_SIZE;
+    frame[0] = static_cast<char>(length >> 24);
+    frame[1] = static_cast<char>(length >> 16);
+    frame[2] = static_cast<char>(length >> 8);
+    frame[3] = static_cast<char>(length);
+    return Create<Packet>(reinterpret_cast<const uint8_t*>(frame.data()), frame.size());
+}
+
+// Reads the body length from a frame header
+static uint32_t ReadFrameLength(const char* header)
+{
+    const uint8_t* bytes = reinterpret_cast<const uint8_t*>(header);
+    return (static_cast<uint32_t>(bytes[0]) << 24) | (static_cast<uint32_t>(bytes[1]) << 16) |
+           (static_cast<uint32_t>(bytes[2]) << 8) | static_cast<uint32_t>(bytes[3]);
+}
+
+template <typename D, typename F, typename C>
+BasicP2PNode<D, F, C>::BasicP2PNode(uint32_t id, uint32_t seed)
     : id(id),
+      isrunning(false),
+      relaying(true),
+      poissonShares(false),
+      network(nullptr),
+      metrics(nullptr),
+      minShareInterval(Seconds(2)),
+      maxShareInterval(Seconds(5)),
+      processing(nullptr),
+      chain(nullptr),
       sharesSent(0),
       sharesReceived(0),
       sharesGenerated(0),
       sharesForwarded(0)
 {
-    isrunning = false;
-    std::random_device rd;
-    rng.seed(rd() + id);
+    rng.Seed(seed, id);
 }
 
-void P2PNode::SetupServerSocket(Ptr<Node> node)
+template <typename D, typename F, typename C>
+void BasicP2PNode<D, F, C>::SetupServerSocket(Ptr<Node> node,
+                                              const TcpProfile& profile,
+                                              ListenState::RegisteredCallback registered)
 {
-    serverSocket = Socket::CreateSocket(node, TcpSocketFactory::GetTypeId());
+    listener = std::make_unique<ListenState>();
+    listener->registered = registered;
+    Ptr<Socket> serverSocket = Socket::CreateSocket(node, TcpSocketFactory::GetTypeId());
+    ApplyTcpProfile(serverSocket, profile);
     InetSocketAddress local = InetSocketAddress(Ipv4Address::GetAny(), id + 1000);
     serverSocket->Bind(local);
     serverSocket->Listen();
     serverSocket->SetAcceptCallback(MakeNullCallback<bool, Ptr<Socket>, const Address&>(),
-                                  MakeCallback(&P2PNode::HandleAccept, this));
+                                  MakeCallback(&BasicP2PNode::HandleAccept, this));
+    listener->serverSocket = serverSocket;
 }
 
-void P2PNode::Stop()
+template <typename D, typename F, typename C>
+void BasicP2PNode<D, F, C>::StopGeneratingShares()
 {
     isrunning = false;
+    shareEvent.Cancel();
+}
+
+template <typename D, typename F, typename C>
+void BasicP2PNode<D, F, C>::ResetGossipState(uint64_t seed)
+{
+    StopGeneratingShares();
+    // The generation model is fixed at setup and kept across replications
+    rng.Seed(seed, id);
+    processedShares = D();
+    if (payload)
+    {
+        Simulator::Cancel(payload->sendEvent);
+    }
+    payload.reset();
+    if (fetch)
+    {
+        for (auto& entry : fetch->requests)
+        {
+            Simulator::Cancel(entry.second.timeout);
+        }
+    }
+    fetch.reset();
+    sharesSent = 0;
+    sharesReceived = 0;
+    sharesGenerated = 0;
+    sharesForwarded = 0;
+    for (PeerEntry& peer : peers)
+    {
+        peer.sharesSent = 0;
+        peer.sharesReceived = 0;
+    }
+}
+
+template <typename D, typename F, typename C>
+void BasicP2PNode<D, F, C>::Stop()
+{
+    StopGeneratingShares();
 
-    if (serverSocket)
+    if (listener)
     {
-        serverSocket->Close();
+        listener->serverSocket->Close();
     }
 
-    for (auto& peer : peersockets)
+    for (auto& peer : peers)
     {
-        peer.second->Close();
+        if (peer.socket)
+        {
+            peer.socket->Close();
+            peer.socket = nullptr;
+        }
+        peer.state = PeerState::Closed;
     }
-    peersockets.clear();
 }
 
-void P2PNode::HandleAccept(Ptr<Socket> socket, const Address& from)
+template <typename D, typename F, typename C>
+void BasicP2PNode<D, F, C>::HandleAccept(Ptr<Socket> socket, const Address& from)
 {
     NS_LOG_INFO("Node " << id << " accepted connection from " << InetSocketAddress::ConvertFrom(from).GetIpv4());
-    socket->SetRecvCallback(MakeCallback(&P2PNode::HandleRead, this));
+    // The peer is identified once its REGISTER message arrives
+    peers.push_back(PeerEntry{UNKNOWN_PEER, socket, Time(), 0, 0, PeerState::Pending, 0, {}});
+    socket->SetRecvCallback(MakeCallback(&BasicP2PNode::HandleRead, this));
 }
 
-void P2PNode::AddPeer(uint32_t peerId)
+template <typename D, typename F, typename C>
+uint32_t BasicP2PNode<D, F, C>::AddPeer(uint32_t peerId)
 {
-    if (std::find(peers.begin(), peers.end(), peerId) == peers.end())
+    auto inserted = peerIndex.emplace(peerId, static_cast<uint32_t>(peers.size()));
+    if (inserted.second)
     {
-        peers.push_back(peerId);
+        peers.push_back(PeerEntry{peerId,
+                                  nullptr,
+                                  Time(),
+                                  0,
+                                  0,
+                                  PeerState::Pending,
+                                  KadcastBucket(id, peerId),
+                                  {}});
     }
+    return inserted.first->second;
 }
 
-void P2PNode::AddPeerSocket(uint32_t peerId, Ptr<Socket> socket)
+template <typename D, typename F, typename C>
+void BasicP2PNode<D, F, C>::AddPeerSocket(uint32_t peerId, Ptr<Socket> socket)
 {
-    peersockets[peerId] = socket;
+    PeerEntry& peer = peers[AddPeer(peerId)];
+    peer.socket = socket;
+    peer.state = PeerState::Connected;
     NS_LOG_INFO("Node " << id << " added socket connection to peer " << peerId);
 }
 
-void P2PNode::StartGeneratingShares()
+template <typename D, typename F, typename C>
+bool BasicP2PNode<D, F, C>::RegisterWithPeer(uint32_t peerId)
 {
-    isrunning = true;
+    auto it = peerIndex.find(peerId);
+    if (it == peerIndex.end() || peers[it->second].state != PeerState::Connected)
+    {
+        return false;
+    }
+    std::string frame(FRAME_HEADER_SIZE, '\0');
+    frame += "REGISTER:" + std::to_string(id);
+    return SendFrame(peers[it->second], MakeFrame(frame));
+}
+
+template <typename D, typename F, typename C>
+void BasicP2PNode<D, F, C>::HandleRegistration(uint32_t slot, uint32_t peerId)
+{
+    NS_LOG_INFO("Node " << id << " received registration from peer " << peerId);
+    PeerEntry& peer = peers[slot];
+    if (peer.peerId == peerId)
+    {
+        return;
+    }
+    if (!peerIndex.emplace(peerId, slot).second)
+    {
+        // A second connection from an already known peer: keep the first one
+        NS_LOG_INFO("Node " << id << " dropping duplicate connection from peer " << peerId);
+        peer.socket->Close();
+        peer.socket = nullptr;
+        peer.state = PeerState::Closed;
+        listener->registered(id, peerId, false);
+        return;
+    }
+    peer.peerId = peerId;
+    peer.bucket = KadcastBucket(id, peerId);
+    peer.state = PeerState::Connected;
+    // Only now can this end send on the connection
+    listener->registered(id, peerId, true);
+}
+
+template <typename D, typename F, typename C>
+void BasicP2PNode<D, F, C>::AttachNetwork(AbstractNetwork* abstractNetwork)
+{
+    network = abstractNetwork;
+}
+
+template <typename D, typename F, typename C>
+void BasicP2PNode<D, F, C>::AddAbstractPeer(uint32_t peerId, Time linkDelay)
+{
+    PeerEntry& peer = peers[AddPeer(peerId)];
+    peer.linkDelay = linkDelay;
+    peer.state = PeerState::Connected;
+    NS_LOG_INFO("Node " << id << " added abstract link to peer " << peerId);
+}
+
+template <typename D, typename F, typename C>
+void BasicP2PNode<D, F, C>::AttachMetrics(GossipMetrics* collector)
+{
+    metrics = collector;
+}
+
+template <typename D, typename F, typename C>
+void BasicP2PNode<D, F, C>::StartGeneratingShares()
+{
+    EnableShareGeneration();
     ScheduleNextShare();
 }
 
-void P2PNode::ScheduleNextShare()
+template <typename D, typename F, typename C>
+void BasicP2PNode<D, F, C>::EnableShareGeneration()
 {
-    std::uniform_real_distribution<double> dist(2.0, 5.0);
-    double nextTime = dist(rng);
+    isrunning = true;
+}
 
+template <typename D, typename F, typename C>
+void BasicP2PNode<D, F, C>::ScheduleNextShare()
+{
     shareEvent =
-        Simulator::Schedule(Seconds(nextTime), &P2PNode::GenerateAndGossipShare, this);
+        Simulator::Schedule(DrawShareInterval(), &BasicP2PNode::GenerateAndGossipShare, this);
+}
+
+template <typename D, typename F, typename C>
+Time BasicP2PNode<D, F, C>::DrawShareInterval()
+{
+    if (poissonShares)
+    {
+        std::exponential_distribution<double> dist(1.0 / minShareInterval.GetSeconds());
+        return Seconds(dist(rng));
+    }
+    std::uniform_real_distribution<double> dist(minShareInterval.GetSeconds(),
+                                                maxShareInterval.GetSeconds());
+    return Seconds(dist(rng));
+}
+
+template <typename D, typename F, typename C>
+void BasicP2PNode<D, F, C>::SetShareInterval(Time minInterval, Time maxInterval)
+{
+    poissonShares = false;
+    minShareInterval = minInterval;
+    maxShareInterval = maxInterval;
+}
+
+template <typename D, typename F, typename C>
+void BasicP2PNode<D, F, C>::SetShareRate(double sharesPerSecond)
+{
+    poissonShares = true;
+    minShareInterval = Seconds(1.0 / sharesPerSecond);
+    maxShareInterval = minShareInterval;
+}
+
+template <typename D, typename F, typename C>
+void BasicP2PNode<D, F, C>::AttachProcessing(ProcessingModel* model)
+{
+    processing = model;
+}
+
+template <typename D, typename F, typename C>
+void BasicP2PNode<D, F, C>::AttachShareChain(ShareChain* shareChain)
+{
+    chain = shareChain;
+}
+
+template <typename D, typename F, typename C>
+void BasicP2PNode<D, F, C>::SetRelaying(bool enabled)
+{
+    relaying = enabled;
 }
 
-void P2PNode::GenerateAndGossipShare()
+template <typename D, typename F, typename C>
+void BasicP2PNode<D, F, C>::GenerateAndGossipShare()
+{
+    if (!isrunning) return;
+    GenerateShare();
+    ScheduleNextShare();
+}
+
+template <typename D, typename F, typename C>
+void BasicP2PNode<D, F, C>::GenerateShare()
 {
     if (peers.empty())
     {
         NS_LOG_INFO("Node " << id << " has no peers to send shares to");
-        ScheduleNextShare();
         return;
     }
     else if (!isrunning) return;
@@ -117,88 +357,823 @@ void P2PNode::GenerateAndGossipShare()
     share.shareId = GenerateUniqueShareId();
     sharesGenerated++;
     share.timestamp = Simulator::Now().GetSeconds();
-    processedShares.insert(share.shareId);
+    share.nonce = 0;
+    share.parent = chain ? chain->GetTip(id) : NO_PARENT;
+    if (processing)
+    {
+        processing->MineShare(id, share);
+    }
+    if (chain)
+    {
+        chain->OnShareGenerated(id, share);
+    }
+    processedShares.Insert(share.shareId);
+    if (metrics)
+    {
+        metrics->OnShareGenerated(share);
+    }
 
     NS_LOG_INFO("Node " << id << " generating new share " << share.shareId);
-    GossipShareToPeers(share);
-    ScheduleNextShare();
+    GossipShareToPeers(share, NO_PEER_SLOT);
 }
 
-void P2PNode::GossipShareToPeers(const Share& share)
+template <typename D, typename F, typename C>
+bool BasicP2PNode<D, F, C>::SendFrame(PeerEntry& peer, Ptr<Packet> frame)
 {
-    for (uint32_t peerId : peers)
+    int bytesSent = peer.socket->Send(frame);
+    if (bytesSent > 0)
     {
-        auto it = peersockets.find(peerId);
-        if (it == peersockets.end())
+        return true;
+    }
+    NS_LOG_INFO("Node " << id << " failed to send to peer " << peer.peerId);
+    peer.socket = nullptr;
+    peer.state = PeerState::Closed;
+    return false;
+}
+
+template <typename D, typename F, typename C>
+bool BasicP2PNode<D, F, C>::SendShare(PeerEntry& peer,
+                                      const Share& share,
+                                      Ptr<Packet>& packet,
+                                      uint32_t& wireBytes)
+{
+    if (peer.state != PeerState::Connected)
+    {
+        NS_LOG_INFO("Node " << id << " has no socket connection to peer " << peer.peerId);
+        return false;
+    }
+    if (network)
+    {
+        // Bytes are counted even without access links, for compact relay and
+        // reconciliation statistics
+        if (wireBytes == 0)
         {
-            NS_LOG_INFO("Node " << id << " has no socket connection to peer " << peerId);
-            continue;
+            std::string frame(FRAME_HEADER_SIZE, '\0');
+            C::Encode(share, frame);
+            wireBytes = frame.size() + IP_TCP_HEADER_SIZE;
         }
-        Ptr<Socket> peerSocket = it->second;
-        std::string shareMsg = share.ToString();
-        Ptr<Packet> packet = Create<Packet>((uint8_t*)shareMsg.c_str(), shareMsg.length());
-        int bytesSent = peerSocket->Send(packet);
-        if (bytesSent > 0)
+        if (network->IsCompact())
         {
-            NS_LOG_INFO("Node " << id << " sending share " << share.originNodeId << ":"
-                            << share.shareId << " to peer " << peerId);
-            sharesSent++;
+            network->Send(MessageKind::CompactShare, id, peer.peerId, share, 0, peer.linkDelay,
+                          wireBytes + network->GetCompactBodyBytes(MessageKind::CompactShare, 0));
+        }
+        else if (network->IsCoded())
+        {
+            uint32_t slot = static_cast<uint32_t>(&peer - peers.data());
+            QueueCodedPackets(share, slot, network->GetPacketCount());
+            SendCodedPackets();
+        }
+        else
+        {
+            // Every chunk carries the share header ahead of its part of the payload
+            for (uint32_t chunk = 0; chunk < network->GetChunkCount(); chunk++)
+            {
+                network->Send(MessageKind::Share, id, peer.peerId, share, chunk, peer.linkDelay,
+                              wireBytes + network->GetChunkBytes(chunk));
+            }
+        }
+    }
+    else
+    {
+        if (!packet)
+        {
+            std::string frame(FRAME_HEADER_SIZE, '\0');
+            C::Encode(share, frame);
+            packet = MakeFrame(frame);
+        }
+        if (!SendFrame(peer, packet->Copy()))
+        {
+            return false;
+        }
+        NS_LOG_INFO("Node " << id << " sending share " << share.originNodeId << ":"
+                        << share.shareId << " to peer " << peer.peerId);
+    }
+    sharesSent++;
+    peer.sharesSent++;
+    return true;
+}
+
+template <typename D, typename F, typename C>
+bool BasicP2PNode<D, F, C>::AddChunk(uint32_t shareId,
+                                     uint32_t chunk,
+                                     uint32_t chunkCount,
+                                     bool& complete)
+{
+    if (!payload)
+    {
+        payload = std::make_unique<PayloadState>();
+    }
+    auto inserted = payload->assemblies.emplace(
+        shareId, PayloadState::Assembly{std::vector<bool>(chunkCount), 0});
+    PayloadState::Assembly& assembly = inserted.first->second;
+    if (assembly.received[chunk])
+    {
+        complete = false;
+        return false;
+    }
+    assembly.received[chunk] = true;
+    assembly.count++;
+    complete = assembly.count == chunkCount;
+    if (complete)
+    {
+        // The dedup set takes over from here
+        payload->assemblies.erase(inserted.first);
+    }
+    return true;
+}
+
+template <typename D, typename F, typename C>
+PayloadState::CodedShare& BasicP2PNode<D, F, C>::GetCodedShare(const Share& share)
+{
+    if (!payload)
+    {
+        payload = std::make_unique<PayloadState>();
+    }
+    auto it = payload->coded.find(share.shareId);
+    if (it == payload->coded.end())
+    {
+        std::string frame(FRAME_HEADER_SIZE, '\0');
+        C::Encode(share, frame);
+        uint32_t wireBytes = frame.size() + IP_TCP_HEADER_SIZE + network->GetChunkBytes(0);
+        RlncDecoder decoder(network->GetChunkCount(), 0, network->GetCodingKernel());
+        it = payload->coded
+                 .emplace(share.shareId,
+                          PayloadState::CodedShare{share, wireBytes, std::move(decoder),
+                                                   std::vector<bool>(peers.size()), 0})
+                 .first;
+    }
+    return it->second;
+}
+
+template <typename D, typename F, typename C>
+bool BasicP2PNode<D, F, C>::AddCodedChunk(const Share& share,
+                                          uint32_t packet,
+                                          uint32_t& index,
+                                          bool& complete)
+{
+    RlncDecoder& decoder = GetCodedShare(share).decoder;
+    bool innovative = decoder.Add(network->GetCodedPacket(packet));
+    complete = innovative && decoder.IsComplete();
+    network->ReleaseCodedPacket(packet, innovative, complete);
+    if (!innovative)
+    {
+        return false;
+    }
+    index = decoder.GetRank() - 1;
+    return true;
+}
+
+template <typename D, typename F, typename C>
+void BasicP2PNode<D, F, C>::QueueCodedPackets(const Share& share, uint32_t slot, uint32_t count)
+{
+    PayloadState::CodedShare& codedShare = GetCodedShare(share);
+    if (codedShare.peerDecoded[slot])
+    {
+        return;
+    }
+    codedShare.queued += count;
+    std::deque<PayloadState::CodedGrant>& grants = payload->grants;
+    if (!grants.empty() && grants.back().shareId == share.shareId && grants.back().slot == slot)
+    {
+        grants.back().count += count;
+        return;
+    }
+    grants.push_back(PayloadState::CodedGrant{share.shareId, slot, count});
+}
+
+template <typename D, typename F, typename C>
+void BasicP2PNode<D, F, C>::SendCodedPackets()
+{
+    // A packet handed to the uplink can no longer be withdrawn, so holding the
+    // rest back lets a peer's decoded notice cancel the ones it does not need
+    while (network->GetUplinkBacklog(id).IsZero())
+    {
+        if (!SendNextCodedPacket())
+        {
+            return;
+        }
+    }
+    if (!payload->sendEvent.IsPending())
+    {
+        payload->sendEvent = Simulator::Schedule(network->GetUplinkBacklog(id),
+                                                 &BasicP2PNode::SendCodedPackets, this);
+    }
+}
+
+template <typename D, typename F, typename C>
+bool BasicP2PNode<D, F, C>::SendNextCodedPacket()
+{
+    std::deque<PayloadState::CodedGrant>& grants = payload->grants;
+    while (!grants.empty())
+    {
+        PayloadState::CodedGrant& grant = grants.front();
+        uint32_t shareId = grant.shareId;
+        PayloadState::CodedShare& codedShare = payload->coded.at(shareId);
+        bool cancelled = codedShare.peerDecoded[grant.slot];
+        const PeerEntry& peer = peers[grant.slot];
+        uint32_t count = cancelled ? grant.count : 1;
+        codedShare.queued -= count;
+        grant.count -= count;
+        if (grant.count == 0)
+        {
+            grants.pop_front();
+        }
+        if (!cancelled)
+        {
+            // A node that generated the share, or forwards it after decoding
+            // it store-and-forward, holds every chunk without a decoder
+            const RlncDecoder* decoder =
+                codedShare.decoder.GetRank() > 0 ? &codedShare.decoder : nullptr;
+            network->Send(MessageKind::Share, id, peer.peerId, codedShare.share,
+                          network->EncodeChunk(decoder), peer.linkDelay, codedShare.wireBytes);
+        }
+        ReleaseCodedShare(shareId);
+        if (!cancelled)
+        {
+            return true;
+        }
+    }
+    return false;
+}
+
+template <typename D, typename F, typename C>
+void BasicP2PNode<D, F, C>::ReleaseCodedShare(uint32_t shareId)
+{
+    auto it = payload->coded.find(shareId);
+    if (it->second.queued == 0 &&
+        (it->second.decoder.IsComplete() || processedShares.Contains(shareId)))
+    {
+        payload->coded.erase(it);
+    }
+}
+
+template <typename D, typename F, typename C>
+void BasicP2PNode<D, F, C>::AnnounceDecoded(const Share& share)
+{
+    const std::vector<bool>& peerDecoded = payload->coded.at(share.shareId).peerDecoded;
+    std::string frame(FRAME_HEADER_SIZE, '\0');
+    C::Encode(share, frame);
+    uint32_t bytes = frame.size() + IP_TCP_HEADER_SIZE;
+    for (uint32_t slot = 0; slot < peers.size(); slot++)
+    {
+        const PeerEntry& peer = peers[slot];
+        if (peer.state == PeerState::Connected && !peerDecoded[slot])
+        {
+            network->Send(MessageKind::Decoded, id, peer.peerId, share, 0, peer.linkDelay, bytes);
+        }
+    }
+}
+
+template <typename D, typename F, typename C>
+void BasicP2PNode<D, F, C>::HandleDecoded(const Share& share, uint32_t peerSlot)
+{
+    if (peerSlot >= peers.size())
+    {
+        return;
+    }
+    // A node done with the share keeps no state for it
+    if ((!payload || payload->coded.find(share.shareId) == payload->coded.end()) &&
+        processedShares.Contains(share.shareId))
+    {
+        return;
+    }
+    // Grants still waiting for the peer are dropped as they come up
+    GetCodedShare(share).peerDecoded[peerSlot] = true;
+}
+
+template <typename D, typename F, typename C>
+bool BasicP2PNode<D, F, C>::ReceiveChunk(const Share& share, uint32_t chunk, uint32_t peerSlot)
+{
+    if (processedShares.Contains(share.shareId))
+    {
+        if (network->IsCoded())
+        {
+            network->ReleaseCodedPacket(chunk, false, false);
+        }
+        return false;
+    }
+    bool complete;
+    // A coded packet stands for the chunk at the node's new rank
+    uint32_t index = chunk;
+    bool added = network->IsCoded()
+                     ? AddCodedChunk(share, chunk, index, complete)
+                     : AddChunk(share.shareId, chunk, network->GetChunkCount(), complete);
+    if (!added)
+    {
+        return false;
+    }
+    if (relaying && network->IsCutThrough())
+    {
+        RelayChunk(share, index, peerSlot);
+        // A relay that decoded the share tops its peers up with spare packets
+        for (uint32_t spare = 1; complete && network->IsCoded() &&
+                                 spare <= AbstractNetwork::CODED_SPARE_PACKETS;
+             spare++)
+        {
+            RelayChunk(share, index + spare, peerSlot);
+        }
+    }
+    if (complete && network->IsCoded())
+    {
+        AnnounceDecoded(share);
+        ReleaseCodedShare(share.shareId);
+    }
+    return complete;
+}
+
+template <typename D, typename F, typename C>
+void BasicP2PNode<D, F, C>::HandleCompactShare(const Share& share, uint32_t peerSlot)
+{
+    if (!processedShares.Insert(share.shareId))
+    {
+        NS_LOG_INFO("Node " << id << " already processed share " << share.originNodeId << ":"
+                            << share.shareId);
+        return;
+    }
+    uint32_t missing = network->ReconstructShare(id, share);
+    if (missing == 0 || peerSlot >= peers.size())
+    {
+        ReceiveShare(share, peerSlot);
+        return;
+    }
+    NS_LOG_INFO("Node " << id << " requests " << missing << " components of share "
+                        << share.originNodeId << ":" << share.shareId);
+    PeerEntry& peer = peers[peerSlot];
+    std::string frame(FRAME_HEADER_SIZE, '\0');
+    C::Encode(share, frame);
+    uint32_t bytes = frame.size() + IP_TCP_HEADER_SIZE +
+                     network->GetCompactBodyBytes(MessageKind::GetComponents, missing);
+    network->Send(MessageKind::GetComponents, id, peer.peerId, share, missing, peer.linkDelay,
+                  bytes);
+}
+
+template <typename D, typename F, typename C>
+void BasicP2PNode<D, F, C>::SendComponents(const Share& share, uint32_t count, uint32_t peerSlot)
+{
+    if (peerSlot >= peers.size() || peers[peerSlot].state != PeerState::Connected)
+    {
+        return;
+    }
+    PeerEntry& peer = peers[peerSlot];
+    std::string frame(FRAME_HEADER_SIZE, '\0');
+    C::Encode(share, frame);
+    uint32_t bytes = frame.size() + IP_TCP_HEADER_SIZE +
+                     network->GetCompactBodyBytes(MessageKind::Components, count);
+    network->Send(MessageKind::Components, id, peer.peerId, share, count, peer.linkDelay, bytes);
+}
+
+template <typename D, typename F, typename C>
+void BasicP2PNode<D, F, C>::RelayChunk(const Share& share, uint32_t chunk, uint32_t fromSlot)
+{
+    std::string frame(FRAME_HEADER_SIZE, '\0');
+    C::Encode(share, frame);
+    uint32_t wireBytes = frame.size() + IP_TCP_HEADER_SIZE + network->GetChunkBytes(chunk);
+    // Each chunk is relayed once, so a share counts as sent with its first chunk
+    if (chunk == 0)
+    {
+        sharesForwarded++;
+    }
+    F::Select(peers, fromSlot, [&](uint32_t slot) {
+        PeerEntry& peer = peers[slot];
+        if (peer.state != PeerState::Connected)
+        {
+            return;
+        }
+        if (network->IsCoded())
+        {
+            QueueCodedPackets(share, slot, 1);
         }
         else
         {
-            NS_LOG_INFO("Node " << id << " failed to send share to peer " << peerId);
-            peersockets.erase(peerId);
+            network->Send(MessageKind::Share, id, peer.peerId, share, chunk, peer.linkDelay,
+                          wireBytes);
         }
+        if (chunk == 0)
+        {
+            sharesSent++;
+            peer.sharesSent++;
+        }
+    });
+    if (network->IsCoded())
+    {
+        SendCodedPackets();
     }
 }
 
-void P2PNode::ReceiveShare(Share share, Ptr<Socket> socket, const Address& from)
+template <typename D, typename F, typename C>
+void BasicP2PNode<D, F, C>::GossipShareToPeers(const Share& share, uint32_t fromSlot)
+{
+    // Encoded lazily, once per share, and copied for each peer socket
+    Ptr<Packet> packet;
+    // Size on the wire, only needed when abstract links model access capacity
+    uint32_t wireBytes = 0;
+
+    F::Select(peers, fromSlot, [&](uint32_t slot) {
+        SendShare(peers[slot], share, packet, wireBytes);
+    });
+}
+
+template <typename D, typename F, typename C>
+void BasicP2PNode<D, F, C>::ReceiveShare(const Share& share, uint32_t peerSlot)
 {    
     sharesReceived++;
-    processedShares.insert(share.shareId);
+    if (peerSlot < peers.size())
+    {
+        peers[peerSlot].sharesReceived++;
+    }
+    if (metrics)
+    {
+        metrics->OnShareReceived(share, id);
+    }
 
     NS_LOG_INFO("Node " << id << " received new share " << share.originNodeId << ":"
                         << share.shareId<<":"<<share.timestamp << " from origin " << share.originNodeId);
 
-    sharesForwarded++;
-    GossipShareToPeers(share);
+    if (processing)
+    {
+        processing->Submit(id, share, peerSlot);
+        return;
+    }
+    ForwardValidatedShare(share, peerSlot);
+}
+
+template <typename D, typename F, typename C>
+void BasicP2PNode<D, F, C>::ForwardValidatedShare(const Share& share, uint32_t peerSlot)
+{
+    if (chain)
+    {
+        if (!ConnectShare(share, peerSlot))
+        {
+            return;
+        }
+        chain->OnShareAccepted(id, share);
+        if (fetch)
+        {
+            CompleteRequest(chain->GetRecord(share));
+        }
+    }
+    // With cut-through the chunks were relayed as they arrived
+    if (relaying && !(network && network->IsCutThrough()))
+    {
+        sharesForwarded++;
+        GossipShareToPeers(share, peerSlot);
+    }
+    if (chain)
+    {
+        // Orphans were validated on arrival; each may in turn release its own
+        for (const FetchState::Orphan& orphan : TakeOrphans(share))
+        {
+            ForwardValidatedShare(orphan.share, orphan.fromSlot);
+        }
+    }
+}
+
+template <typename D, typename F, typename C>
+bool BasicP2PNode<D, F, C>::ConnectShare(const Share& share, uint32_t peerSlot)
+{
+    uint32_t parent = share.parent;
+    if (parent == 0 || parent == NO_PARENT)
+    {
+        return true;
+    }
+    // A parent still in the validation queue counts as connected: the node holds it
+    if (processedShares.Contains(chain->GetShare(parent).shareId) && !IsOrphan(parent))
+    {
+        return true;
+    }
+    NS_LOG_INFO("Node " << id << " buffers share " << share.originNodeId << ":" << share.shareId
+                        << " until its parent " << parent << " arrives");
+    if (AddOrphan(share, peerSlot))
+    {
+        RequestShare(parent, peerSlot < peers.size() ? peerSlot : 0);
+    }
+    return false;
+}
+
+template <typename D, typename F, typename C>
+bool BasicP2PNode<D, F, C>::IsOrphan(uint32_t record) const
+{
+    return fetch && fetch->orphanRecords.count(record) > 0;
+}
+
+template <typename D, typename F, typename C>
+bool BasicP2PNode<D, F, C>::AddOrphan(const Share& share, uint32_t fromSlot)
+{
+    uint32_t record = chain->GetRecord(share);
+    if (record == NO_PARENT)
+    {
+        return false;
+    }
+    if (!fetch)
+    {
+        fetch = std::make_unique<FetchState>();
+    }
+    // A fetched parent can itself arrive as an orphan; its request is done
+    CompleteRequest(record);
+    if (!fetch->orphanRecords.insert(record).second)
+    {
+        return false;
+    }
+    fetch->orphans[share.parent].push_back(FetchState::Orphan{share, record, fromSlot});
+    chain->OnOrphanBuffered();
+    // Nothing to fetch while the parent waits for its own parent or is already requested
+    return fetch->orphanRecords.count(share.parent) == 0 &&
+           fetch->requests.count(share.parent) == 0;
+}
+
+template <typename D, typename F, typename C>
+std::vector<FetchState::Orphan> BasicP2PNode<D, F, C>::TakeOrphans(const Share& share)
+{
+    if (!fetch)
+    {
+        return {};
+    }
+    auto it = fetch->orphans.find(chain->GetRecord(share));
+    if (it == fetch->orphans.end())
+    {
+        return {};
+    }
+    std::vector<FetchState::Orphan> released = std::move(it->second);
+    fetch->orphans.erase(it);
+    for (const FetchState::Orphan& orphan : released)
+    {
+        fetch->orphanRecords.erase(orphan.record);
+    }
+    chain->OnOrphansRemoved(released.size(), false);
+    return released;
+}
+
+template <typename D, typename F, typename C>
+void BasicP2PNode<D, F, C>::CompleteRequest(uint32_t record)
+{
+    auto it = fetch->requests.find(record);
+    if (it == fetch->requests.end())
+    {
+        return;
+    }
+    chain->OnRequestCompleted(Simulator::Now() - it->second.firstSentAt);
+    Simulator::Cancel(it->second.timeout);
+    fetch->requests.erase(it);
+}
+
+template <typename D, typename F, typename C>
+void BasicP2PNode<D, F, C>::FailRequest(uint32_t record)
+{
+    auto it = fetch->requests.find(record);
+    if (it != fetch->requests.end())
+    {
+        Simulator::Cancel(it->second.timeout);
+        fetch->requests.erase(it);
+    }
+    chain->OnRequestFailed();
+    DropOrphans(record);
+}
+
+template <typename D, typename F, typename C>
+void BasicP2PNode<D, F, C>::DropOrphans(uint32_t record)
+{
+    auto it = fetch->orphans.find(record);
+    if (it == fetch->orphans.end())
+    {
+        return;
+    }
+    std::vector<FetchState::Orphan> dropped = std::move(it->second);
+    fetch->orphans.erase(it);
+    chain->OnOrphansRemoved(dropped.size(), true);
+    for (const FetchState::Orphan& orphan : dropped)
+    {
+        fetch->orphanRecords.erase(orphan.record);
+        DropOrphans(orphan.record);
+    }
+}
+
+template <typename D, typename F, typename C>
+void BasicP2PNode<D, F, C>::RequestShare(uint32_t record, uint32_t startSlot)
+{
+    std::string frame(FRAME_HEADER_SIZE, '\0');
+    frame += "GETSHARE:" + std::to_string(record);
+    for (uint32_t i = 0; i < peers.size(); i++)
+    {
+        uint32_t slot = (startSlot + i) % peers.size();
+        PeerEntry& peer = peers[slot];
+        if (peer.state != PeerState::Connected)
+        {
+            continue;
+        }
+        if (network)
+        {
+            network->Send(MessageKind::GetShare, id, peer.peerId, Share(), record, peer.linkDelay,
+                          frame.size() + IP_TCP_HEADER_SIZE);
+        }
+        else if (!SendFrame(peer, MakeFrame(frame)))
+        {
+            continue;
+        }
+        NS_LOG_INFO("Node " << id << " requesting share record " << record << " from peer "
+                            << peer.peerId);
+        EventId timeout = Simulator::Schedule(chain->GetFetchTimeout(),
+                                              &BasicP2PNode::OnFetchTimeout, this, record);
+        auto inserted = fetch->requests.emplace(
+            record, FetchState::Request{slot, 1, Simulator::Now(), timeout});
+        if (!inserted.second)
+        {
+            FetchState::Request& request = inserted.first->second;
+            request.slot = slot;
+            request.attempts++;
+            request.timeout = timeout;
+        }
+        chain->OnRequestSent(!inserted.second);
+        return;
+    }
+    NS_LOG_INFO("Node " << id << " has no peer to request share record " << record << " from");
+    FailRequest(record);
+}
+
+template <typename D, typename F, typename C>
+void BasicP2PNode<D, F, C>::OnFetchTimeout(uint32_t record)
+{
+    auto it = fetch->requests.find(record);
+    if (it == fetch->requests.end())
+    {
+        return;
+    }
+    uint32_t attempts = it->second.attempts;
+    if (attempts >= chain->GetFetchAttempts())
+    {
+        NS_LOG_INFO("Node " << id << " gives up on share record " << record << " after "
+                            << attempts << " requests");
+        FailRequest(record);
+        return;
+    }
+    RequestShare(record, it->second.slot + 1);
+}
+
+template <typename D, typename F, typename C>
+void BasicP2PNode<D, F, C>::HandleGetShare(uint32_t slot, uint32_t record)
+{
+    if (!chain || slot >= peers.size() || record == 0 || record > chain->GetShareCount())
+    {
+        return;
+    }
+    const Share& share = chain->GetShare(record);
+    if (!processedShares.Contains(share.shareId))
+    {
+        NS_LOG_INFO("Node " << id << " cannot serve share record " << record << " to peer "
+                            << peers[slot].peerId);
+        return;
+    }
+    Ptr<Packet> packet;
+    uint32_t wireBytes = 0;
+    if (SendShare(peers[slot], share, packet, wireBytes))
+    {
+        chain->OnShareServed();
+    }
 }
 
-void P2PNode::HandleRead(Ptr<Socket> socket)
+template <typename D, typename F, typename C>
+void BasicP2PNode<D, F, C>::HandleRead(Ptr<Socket> socket)
 {
+    uint32_t slot = FindPeerSlot(socket);
+    if (slot == NO_PEER_SLOT)
+    {
+        NS_LOG_INFO("Node " << id << " received data on an unknown socket");
+        while (socket->Recv())
+        {
+        }
+        return;
+    }
+
     Ptr<Packet> packet;
     Address from;
     while ((packet = socket->RecvFrom(from)))
     {
-        uint8_t* buffer = new uint8_t[packet->GetSize()];
-        packet->CopyData(buffer, packet->GetSize());
-        std::string msg = std::string((char*)buffer, packet->GetSize());
-        delete[] buffer;
-        Share share = Share::FromString(msg);
-        if (msg.find("REGISTER:") == 0)
+        std::string& buffer = peers[slot].rxBuffer;
+        size_t offset = buffer.size();
+        buffer.resize(offset + packet->GetSize());
+        packet->CopyData(reinterpret_cast<uint8_t*>(&buffer[offset]), packet->GetSize());
+    }
+
+    // Handling a message may send on this socket but never adds or removes peer slots,
+    // so the buffer reference stays valid; messages are consumed before it is trimmed
+    std::string& buffer = peers[slot].rxBuffer;
+    size_t consumed = 0;
+    while (buffer.size() - consumed >= FRAME_HEADER_SIZE)
+    {
+        uint32_t length = ReadFrameLength(buffer.data() + consumed);
+        if (buffer.size() - consumed - FRAME_HEADER_SIZE < length)
         {
-            size_t colonPos = msg.find(":");
-            if (colonPos != std::string::npos)
-            {
-                uint32_t peerId = std::stoul(msg.substr(colonPos + 1));
-                NS_LOG_INFO("Node " << id << " received registration from peer " << peerId);
-                peersockets[peerId] = socket;
-                peers.push_back(peerId);
-            }
+            break;
         }
-        else if (processedShares.find(share.shareId) != processedShares.end())
+        HandleMessage(slot, buffer.data() + consumed + FRAME_HEADER_SIZE, length);
+        consumed += FRAME_HEADER_SIZE + length;
+    }
+    buffer.erase(0, consumed);
+}
+
+template <typename D, typename F, typename C>
+void BasicP2PNode<D, F, C>::HandleMessage(uint32_t slot, const char* data, size_t length)
+{
+    static const char REGISTER_PREFIX[] = "REGISTER:";
+    static const size_t REGISTER_PREFIX_SIZE = sizeof(REGISTER_PREFIX) - 1;
+    if (length > REGISTER_PREFIX_SIZE &&
+        std::memcmp(data, REGISTER_PREFIX, REGISTER_PREFIX_SIZE) == 0)
+    {
+        uint32_t peerId = std::stoul(
+            std::string(data + REGISTER_PREFIX_SIZE, length - REGISTER_PREFIX_SIZE));
+        HandleRegistration(slot, peerId);
+        return;
+    }
+    static const char GETSHARE_PREFIX[] = "GETSHARE:";
+    static const size_t GETSHARE_PREFIX_SIZE = sizeof(GETSHARE_PREFIX) - 1;
+    if (length > GETSHARE_PREFIX_SIZE &&
+        std::memcmp(data, GETSHARE_PREFIX, GETSHARE_PREFIX_SIZE) == 0)
+    {
+        uint32_t record = std::stoul(
+            std::string(data + GETSHARE_PREFIX_SIZE, length - GETSHARE_PREFIX_SIZE));
+        HandleGetShare(slot, record);
+        return;
+    }
+
+    Share share;
+    if (!C::Decode(data, length, share))
+    {
+        NS_LOG_INFO("Node " << id << " received a malformed message from peer "
+                            << peers[slot].peerId);
+        return;
+    }
+    if (!processedShares.Insert(share.shareId))
+    {
+        NS_LOG_INFO("Node " << id << " already processed share " << share.originNodeId << ":"
+                            << share.shareId);
+        return;
+    }
+    ReceiveShare(share, slot);
+}
+
+template <typename D, typename F, typename C>
+void BasicP2PNode<D, F, C>::HandleDeliveries(const std::vector<Delivery>& batch)
+{
+    for (const Delivery& delivery : batch)
+    {
+        auto slot = peerIndex.find(delivery.fromNode);
+        uint32_t peerSlot = slot != peerIndex.end() ? slot->second : NO_PEER_SLOT;
+        switch (delivery.kind)
+        {
+        case MessageKind::GetShare:
+            HandleGetShare(peerSlot, delivery.value);
+            continue;
+        case MessageKind::CompactShare:
+            HandleCompactShare(delivery.share, peerSlot);
+            continue;
+        case MessageKind::GetComponents:
+            SendComponents(delivery.share, delivery.value, peerSlot);
+            continue;
+        case MessageKind::Components:
+            // The share was marked processed when its announcement arrived
+            ReceiveShare(delivery.share, peerSlot);
+            continue;
+        case MessageKind::ReconcileRequest:
+        case MessageKind::Sketch:
+        case MessageKind::ReconcileFinish:
+            // Consumed by the network's reconciliation before delivery
+            continue;
+        case MessageKind::Decoded:
+            HandleDecoded(delivery.share, peerSlot);
+            continue;
+        case MessageKind::Share:
+            break;
+        }
+        const Share& share = delivery.share;
+        // A chunked share is received once its last missing chunk is in
+        if (network->GetChunkCount() > 1 && !ReceiveChunk(share, delivery.value, peerSlot))
+        {
+            continue;
+        }
+        if (!processedShares.Insert(share.shareId))
         {
             NS_LOG_INFO("Node " << id << " already processed share " << share.originNodeId << ":"
                                 << share.shareId);
+            continue;
         }
-        else
+        ReceiveShare(share, peerSlot);
+    }
+}
+
+template <typename D, typename F, typename C>
+uint32_t BasicP2PNode<D, F, C>::FindPeerSlot(Ptr<Socket> socket) const
+{
+    for (uint32_t slot = 0; slot < peers.size(); slot++)
+    {
+        if (peers[slot].socket == socket)
         {
-        ReceiveShare(share, socket, from);
+            return slot;
         }
     }
+    return NO_PEER_SLOT;
 }
 
-uint32_t P2PNode::GenerateUniqueShareId()
+template <typename D, typename F, typename C>
+uint32_t BasicP2PNode<D, F, C>::GenerateUniqueShareId()
 {
     uint64_t seed = static_cast<uint64_t>(id) * 1000000 +
                     static_cast<uint64_t>(sharesGenerated) * 1000 +
@@ -208,42 +1183,117 @@ uint32_t P2PNode::GenerateUniqueShareId()
     return static_cast<uint32_t>(hasher(seed));
 }
 
-uint32_t P2PNode::GetId() const
+template <typename D, typename F, typename C>
+uint32_t BasicP2PNode<D, F, C>::GetId() const
 {
     return id;
 }
 
-const std::vector<uint32_t>& P2PNode::GetPeers() const
+template <typename D, typename F, typename C>
+const std::vector<PeerEntry>& BasicP2PNode<D, F, C>::GetPeers() const
 {
     return peers;
 }
 
-uint32_t P2PNode::GetSharesSent() const
+template <typename D, typename F, typename C>
+uint32_t BasicP2PNode<D, F, C>::GetSharesSent() const
 {
     return sharesSent;
 }
 
-uint32_t P2PNode::GetSharesReceived() const
+template <typename D, typename F, typename C>
+uint32_t BasicP2PNode<D, F, C>::GetSharesReceived() const
 {
     return sharesReceived;
 }
 
-uint32_t P2PNode::GetSharesGenerated() const
+template <typename D, typename F, typename C>
+uint32_t BasicP2PNode<D, F, C>::GetSharesGenerated() const
 {
     return sharesGenerated;
 }
 
-uint32_t P2PNode::GetSharesForwarded() const
+template <typename D, typename F, typename C>
+uint32_t BasicP2PNode<D, F, C>::GetSharesForwarded() const
 {
     return sharesForwarded;
 }
 
-size_t P2PNode::GetProcessedSharesCount() const
+template <typename D, typename F, typename C>
+size_t BasicP2PNode<D, F, C>::GetProcessedSharesCount() const
 {
-    return processedShares.size();
+    return processedShares.Size();
 }
 
-size_t P2PNode::GetPeerSocketsCount() const
+template <typename D, typename F, typename C>
+size_t BasicP2PNode<D, F, C>::GetPeerSocketsCount() const
 {
-    return peersockets.size();
-}
\ No newline at end of file
+    size_t count = 0;
+    for (const PeerEntry& peer : peers)
+    {
+        if (peer.state == PeerState::Connected)
+        {
+            count++;
+        }
+    }
+    return count;
+}
+
+template <typename D, typename F, typename C>
+size_t BasicP2PNode<D, F, C>::GetHeapBytes() const
+{
+    size_t bytes = peers.capacity() * sizeof(PeerEntry) + (listener ? sizeof(ListenState) : 0);
+    for (const PeerEntry& peer : peers)
+    {
+        bytes += peer.rxBuffer.capacity() > 15 ? peer.rxBuffer.capacity() : 0;
+    }
+    bytes += peerIndex.size() * (sizeof(void*) + sizeof(std::pair<const uint32_t, uint32_t>)) +
+             peerIndex.bucket_count() * sizeof(void*);
+    if (payload)
+    {
+        bytes += sizeof(PayloadState) + payload->assemblies.bucket_count() * sizeof(void*) +
+                 payload->coded.bucket_count() * sizeof(void*) +
+                 payload->grants.size() * sizeof(PayloadState::CodedGrant);
+        for (const auto& entry : payload->assemblies)
+        {
+            bytes += sizeof(void*) + sizeof(entry) + entry.second.received.capacity() / 8;
+        }
+        for (const auto& entry : payload->coded)
+        {
+            // Rows of coefficients, one per packet that raised the rank
+            const RlncDecoder& decoder = entry.second.decoder;
+            bytes += sizeof(void*) + sizeof(entry) + decoder.GetRank() * decoder.GetWidth() +
+                     entry.second.peerDecoded.capacity() / 8;
+        }
+    }
+    if (fetch)
+    {
+        bytes += sizeof(FetchState) +
+                 fetch->orphanRecords.size() * (sizeof(void*) + sizeof(uint32_t)) +
+                 fetch->requests.size() *
+                     (sizeof(void*) + sizeof(std::pair<const uint32_t, FetchState::Request>));
+        for (const auto& entry : fetch->orphans)
+        {
+            bytes += sizeof(void*) + sizeof(entry) +
+                     entry.second.capacity() * sizeof(FetchState::Orphan);
+        }
+    }
+    return bytes + processedShares.HeapBytes();
+}
+
+// Policy combinations selectable from the command line
+template class BasicP2PNode<HashSetDedup, FloodForward, TextCodec>;
+template class BasicP2PNode<HashSetDedup, FloodForward, BinaryCodec>;
+template class BasicP2PNode<HashSetDedup, SkipSenderForward, TextCodec>;
+template class BasicP2PNode<HashSetDedup, SkipSenderForward, BinaryCodec>;
+template class BasicP2PNode<FlatDedup, FloodForward, TextCodec>;
+template class BasicP2PNode<FlatDedup, FloodForward, BinaryCodec>;
+template class BasicP2PNode<FlatDedup, SkipSenderForward, TextCodec>;
+template class BasicP2PNode<FlatDedup, SkipSenderForward, BinaryCodec>;
+template class BasicP2PNode<HashSetDedup, KadcastForward, TextCodec>;
+template class BasicP2PNode<HashSetDedup, KadcastForward, BinaryCodec>;
+template class BasicP2PNode<FlatDedup, KadcastForward, TextCodec>;
+template class BasicP2PNode<FlatDedup, KadcastForward, BinaryCodec>;
+
+// Memory budget per node, excluding heap-allocated peer, dedup and payload state
+static_assert(sizeof(P2PNode) <= 272, "P2PNode exceeds its per-node memory budget");
@@ -1,11 +1,18 @@
 #ifndef P2P_NODE_H
 #define P2P_NODE_H
 
+#include "gossippolicies.h"
+#include "p2ptypes.h"
+#include "pcgrandom.h"
+#include "rlnc.h"
+#include "tcpprofile.h"
+
 #include "ns3/applications-module.h"
 #include "ns3/core-module.h"
 #include "ns3/internet-module.h"
 #include "ns3/network-module.h"
 
+#include <deque>
 #include <memory>
 #include <random>
 #include <string>
@@ -15,78 +22,332 @@
 
 using namespace ns3;
 
-// Share Structure
-struct Share
+class AbstractNetwork;
+class GossipMetrics;
+class ProcessingModel;
+class ShareChain;
+
+// Payload a node is still receiving or sending, allocated on first use so that
+// nodes without share payloads only carry the pointer to it
+struct PayloadState
+{
+    // Chunks of a share received so far
+    struct Assembly
+    {
+        std::vector<bool> received;
+        uint32_t count;
+    };
+
+    // Shares partially received as chunks, keyed by share id
+    std::unordered_map<uint32_t, Assembly> assemblies;
+    // A share being sent or received as coded packets: its decoder, the peers
+    // that reported decoding it, which are sent no more of its packets, and
+    // the packets granted to peers that are still waiting for the uplink
+    struct CodedShare
+    {
+        Share share;
+        uint32_t wireBytes; // size of one of its packets on the wire
+        RlncDecoder decoder;
+        std::vector<bool> peerDecoded;
+        uint32_t queued; // packets of it in `grants`
+    };
+
+    // Coded packets of a share granted to the peer in `slot`
+    struct CodedGrant
+    {
+        uint32_t shareId;
+        uint32_t slot;
+        uint32_t count;
+    };
+
+    // Shares being sent or received as coded packets, keyed by share id
+    std::unordered_map<uint32_t, CodedShare> coded;
+    // Grants in the order they were made; their packets are handed to the
+    // uplink one at a time as it frees up
+    std::deque<CodedGrant> grants;
+    EventId sendEvent;
+};
+
+// Missing-parent fetch state of a node, allocated with its first orphan
+struct FetchState
 {
-    uint32_t originNodeId; 
-    uint32_t shareId;     
-    double timestamp;      
-    std::string ToString() const;
-    static Share FromString(const std::string& str);
+    // A share waiting for its parent, with its own record and the peer slot
+    // it arrived on
+    struct Orphan
+    {
+        Share share;
+        uint32_t record;
+        uint32_t fromSlot;
+    };
+
+    // A parent being fetched
+    struct Request
+    {
+        uint32_t slot; // peer asked last
+        uint32_t attempts;
+        Time firstSentAt;
+        EventId timeout;
+    };
+
+    // Orphans keyed by the parent record they wait for
+    std::unordered_map<uint32_t, std::vector<Orphan>> orphans;
+    std::unordered_set<uint32_t> orphanRecords;
+    std::unordered_map<uint32_t, Request> requests;
+};
+
+// Accepting end of the TCP transport, allocated by SetupServerSocket so that
+// nodes on the abstract network only carry the pointer to it
+struct ListenState
+{
+    // Called with the node, the peer and whether the connection was kept once
+    // an accepted connection registers
+    typedef Callback<void, uint32_t, uint32_t, bool> RegisteredCallback;
+
+    Ptr<Socket> serverSocket;
+    RegisteredCallback registered;
 };
 
-class P2PNode
+// Gossip node parameterised by its dedup, forwarding and wire-format policies.
+// Member functions are defined in p2pnode.cc and explicitly instantiated there
+// for every supported policy combination.
+template <typename DedupPolicy, typename ForwardPolicy, typename Codec>
+class BasicP2PNode
 {
   private:
     uint32_t id;                                          
-    std::vector<uint32_t> peers;                         
-    Ptr<Socket> serverSocket;                             
-    std::mt19937 rng;                                   
-    EventId shareEvent;
     bool isrunning;                                  
+    bool relaying;
+    bool poissonShares; // intervals are exponential with mean minShareInterval
+    std::vector<PeerEntry> peers;                         
+    std::unordered_map<uint32_t, uint32_t> peerIndex;     
+    std::unique_ptr<ListenState> listener;
+    AbstractNetwork* network;
+    GossipMetrics* metrics;
+    Pcg32 rng;                                   
+    EventId shareEvent;
+    Time minShareInterval;
+    Time maxShareInterval;
+    ProcessingModel* processing;
+    ShareChain* chain;
+    std::unique_ptr<PayloadState> payload;
+    std::unique_ptr<FetchState> fetch;
 
-    std::unordered_set<uint32_t> processedShares;         
-    std::unordered_map<uint32_t, Ptr<Socket>> peersockets; 
+    DedupPolicy processedShares;         
     uint32_t sharesSent;                                  
     uint32_t sharesReceived;                             
     uint32_t sharesGenerated;                            
     uint32_t sharesForwarded;                            
 
+    // Sends one framed message to a connected peer, closing the entry on failure
+    bool SendFrame(PeerEntry& peer, Ptr<Packet> frame);
+
+    // Handles one complete message received from the peer in the given slot
+    void HandleMessage(uint32_t slot, const char* data, size_t length);
+
+    // Binds a REGISTER message to the accepted connection in the given slot
+    void HandleRegistration(uint32_t slot, uint32_t peerId);
+
+    // Sends a share to one connected entry of `peers`, encoding it into `packet`
+    // or sizing it into `wireBytes` on first use so callers can reuse them
+    // across peers
+    bool SendShare(PeerEntry& peer, const Share& share, Ptr<Packet>& packet, uint32_t& wireBytes);
+
+    // Records a chunk of a share; returns false if the node already had it,
+    // and sets `complete` once it holds all `chunkCount` chunks
+    bool AddChunk(uint32_t shareId, uint32_t chunk, uint32_t chunkCount, bool& complete);
+
+    // Returns the coded share entry of a share, creating it with an empty decoder
+    PayloadState::CodedShare& GetCodedShare(const Share& share);
+
+    // Adds a coded packet of a share to its decoder; returns false if it was
+    // not innovative, and otherwise sets `index` to the rank minus one and
+    // `complete` once the share is decoded
+    bool AddCodedChunk(const Share& share, uint32_t packet, uint32_t& index, bool& complete);
+
+    // Grants the peer in the given slot `count` more coded packets of a share,
+    // unless the peer already decoded it
+    void QueueCodedPackets(const Share& share, uint32_t slot, uint32_t count);
+
+    // Sends granted coded packets while the uplink is idle, then waits for it
+    // to free up again
+    void SendCodedPackets();
+
+    // Sends the oldest granted coded packet, skipping grants to peers that
+    // decoded the share since; returns false if none is left
+    bool SendNextCodedPacket();
+
+    // Frees the entry of a coded share once the node holds the share and
+    // has no packets of it waiting
+    void ReleaseCodedShare(uint32_t shareId);
+
+    // Tells the connected peers that have not decoded a share that this node
+    // decoded it
+    void AnnounceDecoded(const Share& share);
+
+    // Records that the peer in the given slot decoded a share, cancelling the
+    // packets of it still waiting for that peer
+    void HandleDecoded(const Share& share, uint32_t peerSlot);
+
+    // Records a payload chunk or coded packet delivered by the abstract
+    // network, relaying it at once with cut-through; returns true when it
+    // completes the share
+    bool ReceiveChunk(const Share& share, uint32_t chunk, uint32_t peerSlot);
+
+    // Rebuilds a compactly announced share from the pool, requesting the
+    // missing components from the announcing peer if there are any
+    void HandleCompactShare(const Share& share, uint32_t peerSlot);
+
+    // Answers a component request from the peer in the given slot
+    void SendComponents(const Share& share, uint32_t count, uint32_t peerSlot);
+
+    // Forwards one payload chunk, or grants a fresh coded packet for the node's
+    // `chunk`-th innovative one, to the peers chosen by the forward policy
+    void RelayChunk(const Share& share, uint32_t chunk, uint32_t fromSlot);
+
+    // Connects a validated share to the sharechain; a share whose parent this
+    // node lacks is buffered as an orphan and the parent is fetched, and
+    // false is returned
+    bool ConnectShare(const Share& share, uint32_t peerSlot);
+
+    // Returns true if the record is waiting in this node's orphan buffer
+    bool IsOrphan(uint32_t record) const;
+
+    // Buffers a share whose parent this node lacks; returns true if the parent
+    // still has to be requested, false if a request is already in flight
+    bool AddOrphan(const Share& share, uint32_t fromSlot);
+
+    // Removes and returns the orphans waiting for a share this node just connected
+    std::vector<FetchState::Orphan> TakeOrphans(const Share& share);
+
+    // Ends the request for a record that arrived, counting its latency
+    void CompleteRequest(uint32_t record);
+
+    // Gives up on a parent and drops the orphans waiting for it
+    void FailRequest(uint32_t record);
+
+    // Discards the orphans waiting for `record` and, in turn, the orphans
+    // waiting for them
+    void DropOrphans(uint32_t record);
+
+    // Sends GETSHARE for a sharechain record to the first connected peer from
+    // `startSlot` on and arms the request timeout; fails the request if no
+    // peer is connected
+    void RequestShare(uint32_t record, uint32_t startSlot);
+
+    // Asks the next peer for a parent that did not arrive in time, or gives
+    // up after the configured number of attempts
+    void OnFetchTimeout(uint32_t record);
+
+    // Answers a GETSHARE from the peer in the given slot if this node has the share
+    void HandleGetShare(uint32_t slot, uint32_t record);
+
   public:
-    // Constructor - initializes a P2P node with the given ID
-    P2PNode(uint32_t id);
+    // Constructor - initializes a P2P node with the given ID; its RNG uses stream `id` of the run seed
+    BasicP2PNode(uint32_t id, uint32_t seed);
 
-    // Sets up the server socket to listen for incoming connections
-    void SetupServerSocket(Ptr<Node> node);
+    // Sets up the server socket to listen for incoming connections with the given TCP
+    // settings; `registered` is called as each accepted connection registers
+    void SetupServerSocket(Ptr<Node> node,
+                           const TcpProfile& profile,
+                           ListenState::RegisteredCallback registered);
     
     // Callback function for handling new connection requests
     void HandleAccept(Ptr<Socket> socket, const Address& from);
     
-    // Adds a new peer to this node's list of peers
-    void AddPeer(uint32_t peerId);
+    // Adds a new peer to this node's peer table (no-op if already present), returns its slot
+    uint32_t AddPeer(uint32_t peerId);
     
     // Associates a socket with a peer ID for communication
     void AddPeerSocket(uint32_t peerId, Ptr<Socket> socket);
+
+    // Announces this node's ID on the socket to the given peer; returns false
+    // if the announcement could not be sent
+    bool RegisterWithPeer(uint32_t peerId);
     
+    // Sends shares over the given abstract network instead of sockets
+    void AttachNetwork(AbstractNetwork* abstractNetwork);
+
+    // Marks a peer reachable over the abstract network with the given link delay
+    void AddAbstractPeer(uint32_t peerId, Time linkDelay);
+
+    // Processes a batch of shares and GETSHARE requests delivered by the abstract network
+    void HandleDeliveries(const std::vector<Delivery>& batch);
+
+    // Reports generated and received shares to the given collector
+    void AttachMetrics(GossipMetrics* collector);
+
     // Begins the share generation process
     void StartGeneratingShares();
+
+    // Marks the node as generating without scheduling its own timer (central driver mode)
+    void EnableShareGeneration();
     
     // Schedules the next share generation event
     void ScheduleNextShare();
+
+    // Sets the range uniform share intervals are drawn from (2-5 s by default),
+    // replacing a share rate set before
+    void SetShareInterval(Time minInterval, Time maxInterval);
+
+    // Generates shares as a Poisson process with the given rate (shares per
+    // second) instead of uniform intervals
+    void SetShareRate(double sharesPerSecond);
+
+    // Routes received shares through the CPU model for validation before they are forwarded
+    void AttachProcessing(ProcessingModel* model);
+
+    // Builds generated shares on this node's sharechain tip and updates the
+    // tip with validated received shares
+    void AttachShareChain(ShareChain* shareChain);
+
+    // Sets whether received shares are forwarded; leaves of a hierarchical
+    // overlay only send the shares they generate
+    void SetRelaying(bool enabled);
+
+    // Draws the delay until this node's next share
+    Time DrawShareInterval();
     
-    // Creates a new share and gossips it to all connected peers
+    // Creates a new share and gossips it to all connected peers, then reschedules
     void GenerateAndGossipShare();
+
+    // Creates a new share and gossips it to all connected peers
+    void GenerateShare();
     
-    // Sends a share to all connected peers
-    void GossipShareToPeers(const Share& share);
+    // Sends a share to the peers chosen by the forward policy
+    void GossipShareToPeers(const Share& share, uint32_t fromSlot);
     
-    // Processes a received share message from another node
-    void ReceiveShare(Share shareMsg, Ptr<Socket> socket, const Address& from);
+    // Processes a received share message from the peer in the given table slot
+    void ReceiveShare(const Share& share, uint32_t peerSlot);
+
+    // Forwards a received share once it has been validated, then releases the
+    // orphans that were waiting for it
+    void ForwardValidatedShare(const Share& share, uint32_t peerSlot);
     
     // Callback function for reading data from a socket
     void HandleRead(Ptr<Socket> socket);
 
+    // Stops generating shares but keeps the connections open
+    void StopGeneratingShares();
+
+    // Clears processed shares, partially received payloads, orphans, parent requests
+    // and counters and restarts the RNG stream from a new seed, keeping the peer
+    // table and connections (used between ensemble replications)
+    void ResetGossipState(uint64_t seed);
+
     // Closes all the connections
     void Stop();
 
+    // Returns the peer table slot whose socket matches, or NO_PEER_SLOT if none
+    uint32_t FindPeerSlot(Ptr<Socket> socket) const;
+
     //Unique shareId is generated
     uint32_t GenerateUniqueShareId();
 
     // Returns the ID of this node
     uint32_t GetId() const;
     
-    // Returns the list of peer IDs connected to this node
-    const std::vector<uint32_t>& GetPeers() const;
+    // Returns the peer table of this node
+    const std::vector<PeerEntry>& GetPeers() const;
     
     // Returns the number of shares sent by this node
     uint32_t GetSharesSent() const;
@@ -106,6 +367,13 @@ class P2PNode
     // Returns the number of active socket connections to peers
     size_t GetPeerSocketsCount() const;
 
+    // Returns an estimate of the heap memory owned by this node (peer table, dedup
+    // state, partially received payloads and orphans)
+    size_t GetHeapBytes() const;
+
 };
 
-#endif
\ No newline at end of file
+// Default node: hash-set dedup, flooding to all peers, text wire format
+typedef BasicP2PNode<HashSetDedup, FloodForward, TextCodec> P2PNode;
+
+#endif
@@ -0,0 +1,113 @@
+#ifndef P2P_TYPES_H
+#define P2P_TYPES_H
+
+#include "ns3/core-module.h"
+#include "ns3/network-module.h"
+
+#include <limits>
+#include <string>
+#include <vector>
+
+using namespace ns3;
+
+// Parent of shares generated without a sharechain
+const uint32_t NO_PARENT = std::numeric_limits<uint32_t>::max();
+
+// Share Structure
+struct Share
+{
+    uint32_t originNodeId; 
+    uint32_t shareId;     
+    double timestamp;      
+    uint32_t nonce;        // proof-of-work nonce, 0 when shares are not mined
+    uint32_t parent;       // sharechain record of the parent share, NO_PARENT without a sharechain
+    std::string ToString() const;
+    static Share FromString(const std::string& str);
+};
+
+// Messages carried by the abstract network
+enum class MessageKind : uint8_t
+{
+    Share,         // a share, or one chunk of its payload
+    GetShare,      // request for a sharechain record
+    CompactShare,  // share header with short IDs of its payload components
+    GetComponents, // request for the components a compact share's receiver lacks
+    Components,    // the requested components
+    ReconcileRequest, // request for a sketch of the peer's reconciliation set
+    Sketch,           // the sketch
+    ReconcileFinish,  // short IDs of the shares found missing by the initiator
+    Decoded           // notice that the sender decoded a coded share
+};
+
+// A message in flight on an abstract link, tagged with the sending node
+struct Delivery
+{
+    Share share;
+    uint32_t fromNode;
+    uint32_t bytes; // size on the wire, used when access links are modelled
+    MessageKind kind;
+    // Payload chunk (coded packet slot with network coding) for Share, sharechain record for GetShare, number of
+    // components for GetComponents and Components, sketch attempt for the
+    // reconciliation messages
+    uint32_t value;
+};
+
+// Connection state of a peer entry
+enum class PeerState : uint8_t
+{
+    Pending,   // peer is known but no socket is attached yet
+    Connected, // socket is attached and usable for sending
+    Closed     // socket failed or was closed
+};
+
+// Overlay id of a node for structured (Kadcast) broadcast: a bijective hash of
+// the node id, so ids are unique, spread uniformly over 32 bits, and known to
+// every node without being exchanged
+inline uint32_t KadcastId(uint32_t nodeId)
+{
+    uint32_t x = nodeId;
+    x ^= x >> 16;
+    x *= 0x7feb352dU;
+    x ^= x >> 15;
+    x *= 0x846ca68bU;
+    x ^= x >> 16;
+    return x;
+}
+
+// Number of Kadcast buckets: one per bit of the overlay id
+const uint8_t KADCAST_BUCKETS = 32;
+
+// Returns the k-bucket one node falls into from the other's point of view: the
+// index of the highest bit in which their overlay ids differ. XOR distance is
+// symmetric, so both ends of a link agree on its bucket.
+inline uint8_t KadcastBucket(uint32_t nodeA, uint32_t nodeB)
+{
+    uint32_t distance = KadcastId(nodeA) ^ KadcastId(nodeB);
+    uint8_t bucket = 0;
+    while (distance >>= 1)
+    {
+        bucket++;
+    }
+    return bucket;
+}
+
+// Peer id of an accepted connection that has not sent REGISTER yet
+const uint32_t UNKNOWN_PEER = std::numeric_limits<uint32_t>::max();
+
+// Peer table slot used for shares that did not arrive from a peer
+const uint32_t NO_PEER_SLOT = std::numeric_limits<uint32_t>::max();
+
+// One row of the per-node peer table
+struct PeerEntry
+{
+    uint32_t peerId;
+    Ptr<Socket> socket;
+    Time linkDelay;
+    uint32_t sharesSent;
+    uint32_t sharesReceived;
+    PeerState state;
+    uint8_t bucket;       // Kadcast bucket of the peer (see KadcastBucket)
+    std::string rxBuffer; // bytes of a partially received frame
+};
+
+#endif
@@ -0,0 +1,62 @@
+#ifndef PCG_RANDOM_H
+#define PCG_RANDOM_H
+
+#include <cstdint>
+#include <limits>
+
+// PCG-XSH-RR generator with 64-bit state and 32-bit output (M.E. O'Neill,
+// pcg-random.org). It keeps 16 bytes of state instead of the ~5 KB of
+// std::mt19937, and the increment selects one of 2^63 independent streams,
+// so every node can draw from its own stream of the same run seed.
+// Satisfies UniformRandomBitGenerator for use with <random> distributions.
+class Pcg32
+{
+  private:
+    uint64_t state;
+    uint64_t inc;
+
+  public:
+    typedef uint32_t result_type;
+
+    Pcg32()
+        : state(0),
+          inc(1)
+    {
+    }
+
+    Pcg32(uint64_t seed, uint64_t stream)
+    {
+        Seed(seed, stream);
+    }
+
+    // Positions the generator at the start of the given stream for the given seed
+    void Seed(uint64_t seed, uint64_t stream)
+    {
+        state = 0;
+        inc = (stream << 1) | 1;
+        (*this)();
+        state += seed;
+        (*this)();
+    }
+
+    static constexpr result_type min()
+    {
+        return 0;
+    }
+
+    static constexpr result_type max()
+    {
+        return std::numeric_limits<result_type>::max();
+    }
+
+    result_type operator()()
+    {
+        uint64_t old = state;
+        state = old * 6364136223846793005ULL + inc;
+        uint32_t xorshifted = static_cast<uint32_t>(((old >> 18) ^ old) >> 27);
+        uint32_t rot = static_cast<uint32_t>(old >> 59);
+        return (xorshifted >> rot) | (xorshifted << ((32 - rot) & 31));
+    }
+};
+
+#endif
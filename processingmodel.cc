@@ -0,0 +1,264 @@
+#include "processingmodel.h"
+
+#include "proofofwork.h"
+
+#include <algorithm>
+#include <chrono>
+#include <random>
+
+NS_LOG_COMPONENT_DEFINE("ProcessingModel");
+
+ProcessingModel::ProcessingModel(uint32_t numNodes,
+                                 ServiceDistribution distribution,
+                                 uint64_t seed)
+    : distribution(distribution),
+      rng(seed, 0xc0de),
+      cpus(numNodes,
+           NodeCpu{1, 0, Time(), {}, 0, Time(), SampleStats(), PowStats(), {}, EventId()}),
+      powTargetBits(0),
+      kernel(Sha256Kernel::Scalar),
+      batchSize(1)
+{
+}
+
+void ProcessingModel::SetValidatedCallback(ValidatedCallback callback)
+{
+    validated = callback;
+}
+
+void ProcessingModel::SetNodeCpu(uint32_t node, uint32_t cores, Time meanServiceTime)
+{
+    cpus[node].cores = cores;
+    cpus[node].meanServiceTime = meanServiceTime;
+}
+
+Time ProcessingModel::DrawServiceTime(const NodeCpu& cpu)
+{
+    if (distribution == ServiceDistribution::Exponential)
+    {
+        std::exponential_distribution<double> dist(1.0 / cpu.meanServiceTime.GetSeconds());
+        return Seconds(dist(rng));
+    }
+    return cpu.meanServiceTime;
+}
+
+void ProcessingModel::EnableProofOfWork(uint32_t targetBits,
+                                        Sha256Kernel hashKernel,
+                                        uint32_t maxBatch)
+{
+    powTargetBits = targetBits;
+    kernel = hashKernel;
+    batchSize = std::max<uint32_t>(1, maxBatch);
+}
+
+bool ProcessingModel::HasProofOfWork() const
+{
+    return powTargetBits > 0;
+}
+
+void ProcessingModel::MineShare(uint32_t node, Share& share)
+{
+    if (!HasProofOfWork())
+    {
+        return;
+    }
+    PowStats& pow = cpus[node].pow;
+    auto start = std::chrono::steady_clock::now();
+    pow.mineHashes += ::MineShare(share, powTargetBits, kernel);
+    pow.mineSeconds +=
+        std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    pow.mined++;
+}
+
+void ProcessingModel::Submit(uint32_t node, const Share& share, uint32_t fromSlot)
+{
+    NodeCpu& cpu = cpus[node];
+    if (!cpu.meanServiceTime.IsStrictlyPositive())
+    {
+        if (!HasProofOfWork())
+        {
+            validated(node, share, fromSlot);
+            return;
+        }
+        // Shares delivered to the node in this event are checked together
+        // once it has been processed
+        if (cpu.queue.empty())
+        {
+            cpu.flush = Simulator::ScheduleNow(&ProcessingModel::FlushQueue, this, node);
+        }
+        cpu.queue.push_back(Job{share, fromSlot, Simulator::Now(), true});
+        return;
+    }
+    cpu.queue.push_back(Job{share, fromSlot, Simulator::Now(), true});
+    if (cpu.busyCores < cpu.cores)
+    {
+        StartBatch(node);
+    }
+    cpu.peakQueue = std::max(cpu.peakQueue, cpu.queue.size());
+}
+
+std::vector<ProcessingModel::Job> ProcessingModel::TakeBatch(NodeCpu& cpu)
+{
+    size_t count = std::min<size_t>(HasProofOfWork() ? batchSize : 1, cpu.queue.size());
+    std::vector<Job> batch(cpu.queue.begin(), cpu.queue.begin() + count);
+    cpu.queue.erase(cpu.queue.begin(), cpu.queue.begin() + count);
+    return batch;
+}
+
+void ProcessingModel::CheckProofs(NodeCpu& cpu, std::vector<Job>& batch)
+{
+    if (!HasProofOfWork())
+    {
+        return;
+    }
+    auto start = std::chrono::steady_clock::now();
+    headers.resize(batch.size() * SHA256_HEADER_SIZE);
+    digests.resize(batch.size() * SHA256_DIGEST_SIZE);
+    for (size_t i = 0; i < batch.size(); i++)
+    {
+        BuildShareHeader(batch[i].share, powTargetBits, &headers[i * SHA256_HEADER_SIZE]);
+    }
+    Sha256dHeaders(kernel, headers.data(), batch.size(), digests.data());
+    for (size_t i = 0; i < batch.size(); i++)
+    {
+        batch[i].valid = MeetsTarget(&digests[i * SHA256_DIGEST_SIZE], powTargetBits);
+        cpu.pow.rejected += !batch[i].valid;
+    }
+    cpu.pow.validateSeconds +=
+        std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    cpu.pow.validated += batch.size();
+    cpu.pow.batches++;
+}
+
+void ProcessingModel::StartBatch(uint32_t node)
+{
+    NodeCpu& cpu = cpus[node];
+    std::vector<Job> batch = TakeBatch(cpu);
+    Time serviceTime;
+    for (const Job& job : batch)
+    {
+        double waited = (Simulator::Now() - job.enqueuedAt).GetSeconds();
+        cpu.wait.Add(waited);
+        wait.Add(waited);
+        serviceTime += DrawServiceTime(cpu);
+    }
+    CheckProofs(cpu, batch);
+    cpu.busyCores++;
+    cpu.busy += serviceTime;
+    cpu.running.erase(std::remove_if(cpu.running.begin(),
+                                     cpu.running.end(),
+                                     [](const EventId& event) { return event.IsExpired(); }),
+                      cpu.running.end());
+    cpu.running.push_back(
+        Simulator::Schedule(serviceTime, &ProcessingModel::FinishBatch, this, node, batch));
+}
+
+void ProcessingModel::FinishBatch(uint32_t node, std::vector<Job> batch)
+{
+    NodeCpu& cpu = cpus[node];
+    cpu.busyCores--;
+    if (!cpu.queue.empty())
+    {
+        StartBatch(node);
+    }
+    for (const Job& job : batch)
+    {
+        if (job.valid)
+        {
+            validated(node, job.share, job.fromSlot);
+        }
+    }
+}
+
+void ProcessingModel::FlushQueue(uint32_t node)
+{
+    NodeCpu& cpu = cpus[node];
+    cpu.peakQueue = std::max(cpu.peakQueue, cpu.queue.size());
+    while (!cpu.queue.empty())
+    {
+        std::vector<Job> batch = TakeBatch(cpu);
+        CheckProofs(cpu, batch);
+        for (const Job& job : batch)
+        {
+            if (job.valid)
+            {
+                validated(node, job.share, job.fromSlot);
+            }
+        }
+    }
+}
+
+const SampleStats& ProcessingModel::GetWait() const
+{
+    return wait;
+}
+
+const SampleStats& ProcessingModel::GetNodeWait(uint32_t node) const
+{
+    return cpus[node].wait;
+}
+
+double ProcessingModel::GetNodeUtilization(uint32_t node, Time elapsed) const
+{
+    const NodeCpu& cpu = cpus[node];
+    if (!elapsed.IsStrictlyPositive())
+    {
+        return 0.0;
+    }
+    return std::min(1.0, cpu.busy.GetSeconds() / (elapsed.GetSeconds() * cpu.cores));
+}
+
+size_t ProcessingModel::GetNodePeakQueue(uint32_t node) const
+{
+    return cpus[node].peakQueue;
+}
+
+const ProcessingModel::PowStats& ProcessingModel::GetNodePow(uint32_t node) const
+{
+    return cpus[node].pow;
+}
+
+ProcessingModel::PowStats ProcessingModel::GetPowTotals() const
+{
+    PowStats totals;
+    for (const NodeCpu& cpu : cpus)
+    {
+        totals.mined += cpu.pow.mined;
+        totals.mineHashes += cpu.pow.mineHashes;
+        totals.mineSeconds += cpu.pow.mineSeconds;
+        totals.validated += cpu.pow.validated;
+        totals.batches += cpu.pow.batches;
+        totals.rejected += cpu.pow.rejected;
+        totals.validateSeconds += cpu.pow.validateSeconds;
+    }
+    return totals;
+}
+
+Sha256Kernel ProcessingModel::GetKernel() const
+{
+    return kernel;
+}
+
+void ProcessingModel::Reset(uint64_t seed)
+{
+    for (NodeCpu& cpu : cpus)
+    {
+        for (EventId& event : cpu.running)
+        {
+            Simulator::Cancel(event);
+        }
+        Simulator::Cancel(cpu.flush);
+        cpu = NodeCpu{cpu.cores,
+                      0,
+                      cpu.meanServiceTime,
+                      {},
+                      0,
+                      Time(),
+                      SampleStats(),
+                      PowStats(),
+                      {},
+                      EventId()};
+    }
+    wait = SampleStats();
+    rng.Seed(seed, 0xc0de);
+}
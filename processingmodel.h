@@ -0,0 +1,152 @@
+#ifndef PROCESSING_MODEL_H
+#define PROCESSING_MODEL_H
+
+#include "pcgrandom.h"
+#include "p2ptypes.h"
+#include "sha256.h"
+#include "statistics.h"
+
+#include <deque>
+#include <vector>
+
+using namespace ns3;
+
+// CPU model of share validation. Every node has a number of cores and a mean
+// service time; received shares wait in a FIFO queue for a free core, are
+// validated for a service time drawn from the configured distribution, and
+// are then handed back to the node for forwarding.
+//
+// With proof of work enabled, nodes also mine the shares they generate and a
+// core that becomes free takes up to a batch of queued shares and checks all
+// their proofs in one multi-buffer SHA-256 pass; shares failing the check are
+// dropped. Nodes without a service time check the shares that arrive in the
+// same event as one batch. Hashing is real work whose wall-clock cost is
+// recorded per node; simulated time still follows the service time model.
+class ProcessingModel
+{
+  public:
+    typedef Callback<void, uint32_t, const Share&, uint32_t> ValidatedCallback;
+
+    // Distribution of the service time around its mean
+    enum class ServiceDistribution
+    {
+        Constant,
+        Exponential
+    };
+
+    // Proof-of-work work done by one node; times are wall-clock seconds
+    struct PowStats
+    {
+        uint64_t mined = 0;
+        uint64_t mineHashes = 0;
+        double mineSeconds = 0.0;
+        uint64_t validated = 0;
+        uint64_t batches = 0;
+        uint64_t rejected = 0;
+        double validateSeconds = 0.0;
+    };
+
+  private:
+    // A share waiting for validation, with the peer slot it arrived on
+    struct Job
+    {
+        Share share;
+        uint32_t fromSlot;
+        Time enqueuedAt;
+        bool valid;
+    };
+
+    struct NodeCpu
+    {
+        uint32_t cores;
+        uint32_t busyCores;
+        Time meanServiceTime;
+        std::deque<Job> queue;
+        size_t peakQueue;
+        Time busy;
+        SampleStats wait;
+        PowStats pow;
+        std::vector<EventId> running; // completions of the batches being validated
+        EventId flush;
+    };
+
+    ValidatedCallback validated;
+    ServiceDistribution distribution;
+    Pcg32 rng;
+    std::vector<NodeCpu> cpus;
+    SampleStats wait;
+    uint32_t powTargetBits; // 0 disables proof of work
+    Sha256Kernel kernel;
+    uint32_t batchSize;
+    std::vector<uint8_t> headers; // scratch for one batch of proofs
+    std::vector<uint8_t> digests;
+
+    // Draws one service time for the node
+    Time DrawServiceTime(const NodeCpu& cpu);
+
+    // Moves the next batch of queued jobs off the node's queue
+    std::vector<Job> TakeBatch(NodeCpu& cpu);
+
+    // Checks the proofs of a batch, marking each job valid or not
+    void CheckProofs(NodeCpu& cpu, std::vector<Job>& batch);
+
+    // Starts validating the next batch of queued jobs on a free core of the node
+    void StartBatch(uint32_t node);
+
+    // Completes a batch, starts the next queued one and hands back the valid shares
+    void FinishBatch(uint32_t node, std::vector<Job> batch);
+
+    // Checks everything queued at a node without a service time
+    void FlushQueue(uint32_t node);
+
+  public:
+    ProcessingModel(uint32_t numNodes, ServiceDistribution distribution, uint64_t seed);
+
+    // Registers the callback invoked with the node, share and peer slot once validated
+    void SetValidatedCallback(ValidatedCallback callback);
+
+    // Sets the node's core count and mean service time (0 validates instantly)
+    void SetNodeCpu(uint32_t node, uint32_t cores, Time meanServiceTime);
+
+    // Turns on proof of work: shares are mined to `targetBits` leading zero
+    // bits and received ones are checked with the kernel in batches of up to
+    // `batchSize`
+    void EnableProofOfWork(uint32_t targetBits, Sha256Kernel hashKernel, uint32_t maxBatch);
+
+    // Returns true if shares are mined and their proofs checked
+    bool HasProofOfWork() const;
+
+    // Mines a share the node generates (no-op without proof of work)
+    void MineShare(uint32_t node, Share& share);
+
+    // Queues a received share for validation at the node
+    void Submit(uint32_t node, const Share& share, uint32_t fromSlot);
+
+    // Returns the time shares waited for a free core, over all nodes, in seconds
+    const SampleStats& GetWait() const;
+
+    // Returns the time shares waited for a free core at the node, in seconds
+    const SampleStats& GetNodeWait(uint32_t node) const;
+
+    // Returns the fraction of the node's core time spent validating over `elapsed`
+    double GetNodeUtilization(uint32_t node, Time elapsed) const;
+
+    // Returns the longest queue the node has had
+    size_t GetNodePeakQueue(uint32_t node) const;
+
+    // Returns the node's proof-of-work counters
+    const PowStats& GetNodePow(uint32_t node) const;
+
+    // Returns the proof-of-work counters summed over all nodes
+    PowStats GetPowTotals() const;
+
+    // Returns the kernel used for proofs
+    Sha256Kernel GetKernel() const;
+
+    // Drops queued and running validations without handing them back, clears
+    // the counters and restarts the service time stream from a new seed,
+    // keeping the CPU settings (used between ensemble replications)
+    void Reset(uint64_t seed);
+};
+
+#endif
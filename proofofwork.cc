@@ -0,0 +1,69 @@
+#include "proofofwork.h"
+
+#include <cstring>
+#include <vector>
+
+static void StoreLittleEndian(uint8_t* p, uint32_t x)
+{
+    p[0] = uint8_t(x);
+    p[1] = uint8_t(x >> 8);
+    p[2] = uint8_t(x >> 16);
+    p[3] = uint8_t(x >> 24);
+}
+
+void BuildShareHeader(const Share& share, uint32_t targetBits, uint8_t* header)
+{
+    std::memset(header, 0, SHA256_HEADER_SIZE);
+    StoreLittleEndian(header, 0x20000000);              // version
+    StoreLittleEndian(header + 4, share.parent);        // previous block: the sharechain parent
+    StoreLittleEndian(header + 8, share.originNodeId);
+    StoreLittleEndian(header + 36, share.shareId);      // merkle root: the share's payload
+    StoreLittleEndian(header + 68, share.originNodeId); // time: fixed per miner
+    StoreLittleEndian(header + 72, targetBits);         // bits
+    StoreLittleEndian(header + 76, share.nonce);
+}
+
+bool MeetsTarget(const uint8_t* digest, uint32_t targetBits)
+{
+    // Little-endian: the most significant bytes come last
+    uint32_t index = SHA256_DIGEST_SIZE;
+    for (; targetBits >= 8; targetBits -= 8)
+    {
+        if (digest[--index] != 0)
+        {
+            return false;
+        }
+    }
+    return targetBits == 0 || (digest[index - 1] >> (8 - targetBits)) == 0;
+}
+
+uint64_t MineShare(Share& share, uint32_t targetBits, Sha256Kernel kernel)
+{
+    uint32_t lanes = Sha256KernelLanes(kernel);
+    std::vector<uint8_t> headers(lanes * SHA256_HEADER_SIZE);
+    std::vector<uint8_t> digests(lanes * SHA256_DIGEST_SIZE);
+    BuildShareHeader(share, targetBits, headers.data());
+    for (uint32_t lane = 1; lane < lanes; lane++)
+    {
+        std::memcpy(&headers[lane * SHA256_HEADER_SIZE], headers.data(), SHA256_HEADER_SIZE);
+    }
+
+    uint64_t attempts = 0;
+    for (uint32_t nonce = 0;; nonce += lanes)
+    {
+        for (uint32_t lane = 0; lane < lanes; lane++)
+        {
+            StoreLittleEndian(&headers[lane * SHA256_HEADER_SIZE + 76], nonce + lane);
+        }
+        Sha256dHeaders(kernel, headers.data(), lanes, digests.data());
+        attempts += lanes;
+        for (uint32_t lane = 0; lane < lanes; lane++)
+        {
+            if (MeetsTarget(&digests[lane * SHA256_DIGEST_SIZE], targetBits))
+            {
+                share.nonce = nonce + lane;
+                return attempts;
+            }
+        }
+    }
+}
@@ -0,0 +1,31 @@
+#ifndef PROOF_OF_WORK_H
+#define PROOF_OF_WORK_H
+
+#include "p2ptypes.h"
+#include "sha256.h"
+
+using namespace ns3;
+
+// Proof of work for shares. A share commits to an 80-byte block header laid
+// out like Bitcoin's (version, previous block, merkle root, time, bits,
+// nonce); it is valid if the double SHA-256 of the header, read as a
+// little-endian 256-bit number, has its top `targetBits` bits clear.
+//
+// Only the nonce travels with the share. The other header fields are derived
+// from the share's origin, id and parent, which both codecs carry exactly, so
+// a receiver rebuilds the same header the miner hashed.
+
+// Largest supported difficulty: about 2^24 hashes to mine one share
+const uint32_t MAX_POW_TARGET_BITS = 24;
+
+// Writes the header the share commits to, including its nonce
+void BuildShareHeader(const Share& share, uint32_t targetBits, uint8_t* header);
+
+// Returns true if the digest meets a target of `targetBits` leading zero bits
+bool MeetsTarget(const uint8_t* digest, uint32_t targetBits);
+
+// Searches nonces until the share meets the target, trying one candidate per
+// kernel lane in each pass; returns the number of hashes computed
+uint64_t MineShare(Share& share, uint32_t targetBits, Sha256Kernel kernel);
+
+#endif
@@ -0,0 +1,302 @@
+#include "reconciliation.h"
+
+#include "abstractnetwork.h"
+
+#include <algorithm>
+#include <cmath>
+
+NS_LOG_COMPONENT_DEFINE("Reconciliation");
+
+Reconciliation::Reconciliation(AbstractNetwork* abstractNetwork, Time roundInterval)
+    : network(abstractNetwork),
+      interval(roundInterval)
+{
+}
+
+uint64_t Reconciliation::Key(uint32_t a, uint32_t b)
+{
+    return (static_cast<uint64_t>(a) << 32) | b;
+}
+
+Reconciliation::Link* Reconciliation::FindLink(uint32_t a, uint32_t b)
+{
+    auto it = linkIndex.find(Key(std::min(a, b), std::max(a, b)));
+    return it != linkIndex.end() ? &links[it->second] : nullptr;
+}
+
+void Reconciliation::AddLink(uint32_t from, uint32_t to, Time delay)
+{
+    reconciled.insert(Key(from, to));
+    uint64_t key = Key(std::min(from, to), std::max(from, to));
+    if (linkIndex.count(key) == 0)
+    {
+        linkIndex[key] = static_cast<uint32_t>(links.size());
+        links.push_back(Link{std::min(from, to), std::max(from, to), delay, {}, false, 0, 0.0, 0,
+                             Iblt(0), PendingSet(), std::vector<uint32_t>()});
+    }
+}
+
+void Reconciliation::Start(uint32_t seed)
+{
+    Pcg32 rng(seed, 0xe71a);
+    for (uint32_t i = 0; i < links.size(); i++)
+    {
+        Time offset = Seconds(interval.GetSeconds() * (rng() / 4294967296.0));
+        Simulator::Schedule(offset, &Reconciliation::OnTimer, this, i);
+    }
+}
+
+bool Reconciliation::Absorb(uint32_t fromNode, uint32_t toNode, const Share& share, uint32_t bytes)
+{
+    uint64_t direction = Key(fromNode, toNode);
+    if (reconciled.count(direction) == 0 || replying.count(direction) > 0)
+    {
+        return false;
+    }
+    Link* link = FindLink(fromNode, toNode);
+    Side& side = link->sides[fromNode == link->low ? 0 : 1];
+    if (side.heard.count(share.shareId) == 0)
+    {
+        side.pending.emplace(share.shareId, Pending{share, bytes});
+    }
+    return true;
+}
+
+void Reconciliation::OnShareDelivered(uint32_t fromNode, uint32_t toNode, const Share& share)
+{
+    Link* link = FindLink(fromNode, toNode);
+    if (!link)
+    {
+        return;
+    }
+    Side& receiver = link->sides[toNode == link->low ? 0 : 1];
+    receiver.heard.insert(share.shareId);
+    receiver.pending.erase(share.shareId);
+}
+
+void Reconciliation::OnShareRequested(uint32_t fromNode, uint32_t toNode)
+{
+    replying.insert(Key(toNode, fromNode));
+}
+
+void Reconciliation::ClearRequests()
+{
+    replying.clear();
+}
+
+void Reconciliation::SendMessage(const Link& link,
+                                 MessageKind kind,
+                                 bool fromLow,
+                                 uint32_t attempt,
+                                 uint32_t bytes)
+{
+    stats.sketchBytes += bytes;
+    network->Transmit(kind, fromLow ? link.low : link.high, fromLow ? link.high : link.low, Share(),
+                      attempt, link.delay, bytes);
+}
+
+void Reconciliation::SendShares(const Link& link, bool fromLow, const PendingSet& shares)
+{
+    for (const auto& entry : shares)
+    {
+        stats.reconciledShares++;
+        network->Transmit(MessageKind::Share, fromLow ? link.low : link.high,
+                          fromLow ? link.high : link.low, entry.second.share, 0, link.delay,
+                          entry.second.bytes);
+    }
+}
+
+void Reconciliation::OnTimer(uint32_t index)
+{
+    Simulator::Schedule(interval, &Reconciliation::OnTimer, this, index);
+    Link& link = links[index];
+    if (link.busy || (link.sides[0].pending.empty() && link.sides[1].pending.empty()))
+    {
+        return;
+    }
+    link.busy = true;
+    link.attempt = 0;
+    StartRound(link);
+}
+
+void Reconciliation::StartRound(Link& link)
+{
+    link.lowSize = static_cast<uint32_t>(link.sides[0].pending.size());
+    SendMessage(link, MessageKind::ReconcileRequest, true, link.attempt, MESSAGE_OVERHEAD_BYTES);
+}
+
+void Reconciliation::HandleRequest(Link& link)
+{
+    link.highSnapshot = std::move(link.sides[1].pending);
+    link.sides[1].pending.clear();
+    uint32_t highSize = static_cast<uint32_t>(link.highSnapshot.size());
+    uint32_t gap = highSize > link.lowSize ? highSize - link.lowSize : link.lowSize - highSize;
+    uint32_t estimate =
+        gap + static_cast<uint32_t>(std::ceil(link.q * std::min(highSize, link.lowSize))) + 1;
+    link.sketch = Iblt(Iblt::CellsFor(estimate) << link.attempt);
+    for (const auto& entry : link.highSnapshot)
+    {
+        link.sketch.Insert(entry.first);
+    }
+    SendMessage(link, MessageKind::Sketch, false, link.attempt,
+                MESSAGE_OVERHEAD_BYTES + link.sketch.GetBytes());
+}
+
+void Reconciliation::HandleSketch(Link& link)
+{
+    PendingSet& lowSet = link.sides[0].pending;
+    Iblt local(link.sketch.GetCellCount());
+    for (const auto& entry : lowSet)
+    {
+        local.Insert(entry.first);
+    }
+    local.Subtract(link.sketch);
+    std::vector<uint32_t> onlyLow;
+    std::vector<uint32_t> onlyHigh;
+    uint32_t listBytes = 0;
+    if (!local.Decode(onlyLow, onlyHigh))
+    {
+        stats.decodeFailures++;
+        if (link.attempt + 1 < MAX_ATTEMPTS)
+        {
+            // Put high's shares back and retry with a sketch twice the size
+            link.sides[1].pending.insert(link.highSnapshot.begin(), link.highSnapshot.end());
+            link.highSnapshot.clear();
+            link.attempt++;
+            StartRound(link);
+            return;
+        }
+        // Fall back to exchanging the full short ID lists
+        stats.fallbacks++;
+        onlyLow.clear();
+        onlyHigh.clear();
+        for (const auto& entry : lowSet)
+        {
+            if (link.highSnapshot.count(entry.first) == 0)
+            {
+                onlyLow.push_back(entry.first);
+            }
+        }
+        for (const auto& entry : link.highSnapshot)
+        {
+            if (lowSet.count(entry.first) == 0)
+            {
+                onlyHigh.push_back(entry.first);
+            }
+        }
+        listBytes =
+            SHORT_ID_BYTES * static_cast<uint32_t>(lowSet.size() + link.highSnapshot.size());
+    }
+    else
+    {
+        uint32_t lowSize = static_cast<uint32_t>(lowSet.size());
+        uint32_t highSize = static_cast<uint32_t>(link.highSnapshot.size());
+        uint32_t gap = highSize > lowSize ? highSize - lowSize : lowSize - highSize;
+        uint32_t smaller = std::min(lowSize, highSize);
+        uint32_t difference = static_cast<uint32_t>(onlyLow.size() + onlyHigh.size());
+        if (smaller > 0)
+        {
+            link.q = std::min(1.0, static_cast<double>(difference - std::min(difference, gap)) /
+                                       smaller);
+        }
+        stats.difference.Add(difference);
+    }
+
+    PendingSet toHigh;
+    for (uint32_t key : onlyLow)
+    {
+        auto it = lowSet.find(key);
+        if (it != lowSet.end())
+        {
+            toHigh.insert(*it);
+        }
+    }
+    // Everything in low's set is now either sent or held by both ends
+    lowSet.clear();
+    SendShares(link, true, toHigh);
+
+    link.wanted = std::move(onlyHigh);
+    uint32_t wanted = static_cast<uint32_t>(link.wanted.size());
+    if (wanted == 0 && listBytes == 0)
+    {
+        EndRound(link);
+        return;
+    }
+    SendMessage(link, MessageKind::ReconcileFinish, true, link.attempt,
+                MESSAGE_OVERHEAD_BYTES + SHORT_ID_BYTES * wanted + listBytes);
+}
+
+void Reconciliation::HandleFinish(Link& link)
+{
+    PendingSet toLow;
+    for (uint32_t key : link.wanted)
+    {
+        auto it = link.highSnapshot.find(key);
+        if (it != link.highSnapshot.end())
+        {
+            toLow.insert(*it);
+        }
+    }
+    SendShares(link, false, toLow);
+    EndRound(link);
+}
+
+void Reconciliation::EndRound(Link& link)
+{
+    stats.rounds++;
+    link.busy = false;
+    link.attempt = 0;
+    link.highSnapshot.clear();
+    link.wanted.clear();
+    link.sketch = Iblt(0);
+    link.sides[0].heard.clear();
+    link.sides[1].heard.clear();
+}
+
+void Reconciliation::Receive(uint32_t toNode, const Delivery& delivery)
+{
+    Link* link = FindLink(delivery.fromNode, toNode);
+    // Messages of a round abandoned by Reset or superseded by a retry are dropped
+    if (!link || !link->busy || delivery.value != link->attempt)
+    {
+        return;
+    }
+    switch (delivery.kind)
+    {
+    case MessageKind::ReconcileRequest:
+        HandleRequest(*link);
+        break;
+    case MessageKind::Sketch:
+        HandleSketch(*link);
+        break;
+    case MessageKind::ReconcileFinish:
+        HandleFinish(*link);
+        break;
+    default:
+        NS_LOG_WARN("Unexpected message kind on a reconciling link");
+        break;
+    }
+}
+
+size_t Reconciliation::GetLinkCount() const
+{
+    return links.size();
+}
+
+const Reconciliation::Stats& Reconciliation::GetStats() const
+{
+    return stats;
+}
+
+void Reconciliation::Reset()
+{
+    for (Link& link : links)
+    {
+        link.sides[0] = Side();
+        link.sides[1] = Side();
+        link.q = 0.0;
+        EndRound(link);
+    }
+    replying.clear();
+    stats = Stats();
+}
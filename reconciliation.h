@@ -0,0 +1,164 @@
+#ifndef RECONCILIATION_H
+#define RECONCILIATION_H
+
+#include "iblt.h"
+#include "p2ptypes.h"
+#include "pcgrandom.h"
+#include "statistics.h"
+
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+
+using namespace ns3;
+
+class AbstractNetwork;
+
+// Erlay-style share relay for the abstract network (Naumenko et al., "Erlay:
+// Efficient Transaction Relay for Bitcoin"). A node floods shares only to its
+// first few peers; on every other link the shares it would have sent are
+// queued in a per-direction reconciliation set. Every interval the lower-id
+// end of such a link asks the other for an IBLT sketch of its set, sized for
+// the expected set difference, subtracts its own and decodes the difference:
+// it sends the shares only it has and asks for the ones only the peer has.
+// Shares both ends already hold cancel out, so the bytes per round follow the
+// difference, not the number of shares, and the cost per share stays roughly
+// flat as the degree grows. A sketch that fails to decode is retried at twice
+// the size, and after that the two sets are exchanged in full.
+class Reconciliation
+{
+  public:
+    // Bytes added to every reconciliation message for headers
+    static const uint32_t MESSAGE_OVERHEAD_BYTES = 48;
+    // Bytes per short ID in a request for missing shares
+    static const uint32_t SHORT_ID_BYTES = 4;
+    // Sketch sizes tried before falling back to a full exchange
+    static const uint32_t MAX_ATTEMPTS = 2;
+
+    // Counters over all links
+    struct Stats
+    {
+        uint64_t rounds = 0;          // reconciliations completed
+        uint64_t decodeFailures = 0;
+        uint64_t fallbacks = 0;       // rounds that exchanged the full sets
+        uint64_t reconciledShares = 0; // shares sent because a round found them missing
+        uint64_t sketchBytes = 0;     // requests, sketches and lists of missing shares
+        SampleStats difference;       // decoded set difference per round
+    };
+
+  private:
+    // A share queued for a peer with its size on the wire
+    struct Pending
+    {
+        Share share;
+        uint32_t bytes;
+    };
+
+    typedef std::unordered_map<uint32_t, Pending> PendingSet;
+
+    // One end of a link: the shares queued for the other end and the shares
+    // the other end sent, which are never queued back to it
+    struct Side
+    {
+        PendingSet pending;
+        std::unordered_set<uint32_t> heard;
+    };
+
+    // A link between `low` and `high` (low < high); low initiates rounds
+    struct Link
+    {
+        uint32_t low;
+        uint32_t high;
+        Time delay;
+        Side sides[2]; // [0] queued by low for high, [1] queued by high for low
+        bool busy;
+        uint32_t attempt;
+        double q;                  // Erlay's estimate of the difference beyond the size gap
+        uint32_t lowSize;          // low's set size announced in the request
+        Iblt sketch;               // high's sketch in flight
+        PendingSet highSnapshot;   // high's shares covered by the sketch
+        std::vector<uint32_t> wanted; // shares low asked high for
+    };
+
+    AbstractNetwork* network;
+    Time interval;
+    std::vector<Link> links;
+    std::unordered_map<uint64_t, uint32_t> linkIndex;
+    // Directions (from << 32 | to) that reconcile instead of flooding
+    std::unordered_set<uint64_t> reconciled;
+    // Directions answering a GETSHARE in the batch being delivered
+    std::unordered_set<uint64_t> replying;
+    Stats stats;
+
+    static uint64_t Key(uint32_t a, uint32_t b);
+
+    // Returns the link between two nodes, or nullptr if they do not reconcile
+    Link* FindLink(uint32_t a, uint32_t b);
+
+    // Sends a reconciliation message of the given size between the ends of a
+    // link; `attempt` tells the messages of a retried round apart
+    void SendMessage(const Link& link,
+                     MessageKind kind,
+                     bool fromLow,
+                     uint32_t attempt,
+                     uint32_t bytes);
+
+    // Sends queued shares to the other end of a link
+    void SendShares(const Link& link, bool fromLow, const PendingSet& shares);
+
+    // Runs every interval for a link: starts a round unless one is in progress
+    void OnTimer(uint32_t index);
+
+    // Low asks high for a sketch
+    void StartRound(Link& link);
+
+    // High answers a request with a sketch of its set
+    void HandleRequest(Link& link);
+
+    // Low subtracts its own sketch and decodes the difference
+    void HandleSketch(Link& link);
+
+    // High sends the shares low found missing
+    void HandleFinish(Link& link);
+
+    // Ends a round, clearing what both ends heard from each other
+    void EndRound(Link& link);
+
+  public:
+    Reconciliation(AbstractNetwork* abstractNetwork, Time roundInterval);
+
+    // Makes `from` reconcile the shares it sends to `to` instead of flooding them
+    void AddLink(uint32_t from, uint32_t to, Time delay);
+
+    // Schedules the first round of every link at a random offset within the interval
+    void Start(uint32_t seed);
+
+    // Queues a share the node sends on a reconciled direction; returns false
+    // if the direction floods or answers a GETSHARE and the share should be
+    // sent now
+    bool Absorb(uint32_t fromNode, uint32_t toNode, const Share& share, uint32_t bytes);
+
+    // Notes a share delivered from one node to another so it is not queued back
+    void OnShareDelivered(uint32_t fromNode, uint32_t toNode, const Share& share);
+
+    // Notes a GETSHARE delivered from one node to another, so the answer goes
+    // out at once instead of waiting for the next round
+    void OnShareRequested(uint32_t fromNode, uint32_t toNode);
+
+    // Forgets the GETSHAREs once the batch that carried them was handled
+    void ClearRequests();
+
+    // Handles a reconciliation message arriving at a node
+    void Receive(uint32_t toNode, const Delivery& delivery);
+
+    // Returns the number of reconciling links
+    size_t GetLinkCount() const;
+
+    const Stats& GetStats() const;
+
+    // Forgets queued shares, rounds in progress and counters (used between
+    // ensemble replications); link timers keep running
+    void Reset();
+};
+
+#endif
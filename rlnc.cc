@@ -0,0 +1,88 @@
+#include "rlnc.h"
+
+#include <cstring>
+
+RlncDecoder::RlncDecoder(uint32_t chunks, uint32_t payloadBytes, Gf256Kernel rowKernel)
+    : k(chunks),
+      width(chunks + payloadBytes),
+      kernel(rowKernel),
+      pivotRow(chunks, -1),
+      scratch(chunks + payloadBytes)
+{
+    rows.reserve(static_cast<size_t>(k) * width);
+    pivots.reserve(k);
+}
+
+bool RlncDecoder::Add(const uint8_t* packet)
+{
+    if (IsComplete())
+    {
+        return false;
+    }
+    uint8_t* candidate = scratch.data();
+    std::memcpy(candidate, packet, width);
+    // Every held row has a 1 at its pivot and 0 at the other rows' pivots, so
+    // one pass clears the candidate's coefficients at all pivots
+    for (uint32_t r = 0; r < pivots.size(); r++)
+    {
+        Gf256MulAdd(kernel, candidate, &rows[static_cast<size_t>(r) * width],
+                    candidate[pivots[r]], width);
+    }
+    uint32_t pivot = 0;
+    while (pivot < k && candidate[pivot] == 0)
+    {
+        pivot++;
+    }
+    if (pivot == k)
+    {
+        return false;
+    }
+    Gf256Scale(kernel, candidate, Gf256Inverse(candidate[pivot]), width);
+    for (uint32_t r = 0; r < pivots.size(); r++)
+    {
+        uint8_t* row = &rows[static_cast<size_t>(r) * width];
+        Gf256MulAdd(kernel, row, candidate, row[pivot], width);
+    }
+    pivotRow[pivot] = static_cast<int32_t>(pivots.size());
+    pivots.push_back(pivot);
+    rows.insert(rows.end(), candidate, candidate + width);
+    return true;
+}
+
+void RlncDecoder::Combine(Pcg32& rng, uint8_t* packet) const
+{
+    std::memset(packet, 0, width);
+    for (uint32_t r = 0; r < pivots.size(); r++)
+    {
+        Gf256MulAdd(kernel, packet, &rows[static_cast<size_t>(r) * width],
+                    static_cast<uint8_t>(rng()), width);
+    }
+}
+
+void RlncDecoder::RandomCoefficients(Pcg32& rng, uint32_t chunks, uint8_t* coefficients)
+{
+    for (uint32_t i = 0; i < chunks; i++)
+    {
+        coefficients[i] = static_cast<uint8_t>(rng());
+    }
+}
+
+uint32_t RlncDecoder::GetRank() const
+{
+    return static_cast<uint32_t>(pivots.size());
+}
+
+bool RlncDecoder::IsComplete() const
+{
+    return pivots.size() == k;
+}
+
+uint32_t RlncDecoder::GetWidth() const
+{
+    return width;
+}
+
+const uint8_t* RlncDecoder::GetChunk(uint32_t index) const
+{
+    return &rows[static_cast<size_t>(pivotRow[index]) * width + k];
+}
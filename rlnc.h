@@ -0,0 +1,55 @@
+#ifndef RLNC_H
+#define RLNC_H
+
+#include "gf256.h"
+#include "pcgrandom.h"
+
+#include <vector>
+
+// Random linear network coding over GF(2^8) (Ho et al., "A random linear
+// network coding approach to multicast"). A payload of `k` chunks travels as
+// coded packets: a vector of k coefficients followed by the matching linear
+// combination of the chunks. A node keeps the packets it received in reduced
+// row echelon form, so a packet is innovative exactly when it raises the
+// rank, the payload is decoded once the rank reaches k, and a relay can send
+// fresh combinations of what it holds before it has decoded anything.
+//
+// With a payload width of 0 only the coefficient vectors are kept, which is
+// all the simulator needs to know which packets are innovative.
+class RlncDecoder
+{
+  private:
+    uint32_t k;
+    uint32_t width; // coefficients plus payload bytes per row
+    Gf256Kernel kernel;
+    std::vector<uint8_t> rows;       // `rank` rows of `width` bytes
+    std::vector<uint32_t> pivots;    // leading coefficient of each row
+    std::vector<int32_t> pivotRow;   // row whose pivot is a column, or -1
+    std::vector<uint8_t> scratch;
+
+  public:
+    RlncDecoder(uint32_t chunks, uint32_t payloadBytes, Gf256Kernel rowKernel);
+
+    // Adds a coded packet of GetWidth() bytes; returns false if it was a
+    // combination of the packets already held
+    bool Add(const uint8_t* packet);
+
+    // Writes a random combination of the held packets to `packet`
+    void Combine(Pcg32& rng, uint8_t* packet) const;
+
+    // Writes a random combination of all k chunks of a fully known payload;
+    // only the coefficient part is filled
+    static void RandomCoefficients(Pcg32& rng, uint32_t chunks, uint8_t* coefficients);
+
+    uint32_t GetRank() const;
+
+    bool IsComplete() const;
+
+    // Returns the bytes of a coded packet
+    uint32_t GetWidth() const;
+
+    // Returns the decoded payload bytes of a chunk once the decoder is complete
+    const uint8_t* GetChunk(uint32_t index) const;
+};
+
+#endif
@@ -0,0 +1,300 @@
+#include "sha256.h"
+
+#include <cstring>
+
+// The multi-buffer kernels are the scalar code compiled for a vector of lanes:
+// the round function is a template over the word type, written with GCC/Clang
+// vector extensions, and always inlined into small per-ISA entry points whose
+// target attribute lets the compiler emit SSE4.1 or AVX2 for it. No special
+// build flags are needed; the entry points only run if the CPU reports support.
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#define SHA256_X86 1
+#endif
+
+#define SHA256_INLINE inline __attribute__((always_inline))
+
+static const uint32_t K[64] = {
+    0x428a2f98, 0x71374491, 0xb5c0fbcf, 0xe9b5dba5, 0x3956c25b, 0x59f111f1, 0x923f82a4,
+    0xab1c5ed5, 0xd807aa98, 0x12835b01, 0x243185be, 0x550c7dc3, 0x72be5d74, 0x80deb1fe,
+    0x9bdc06a7, 0xc19bf174, 0xe49b69c1, 0xefbe4786, 0x0fc19dc6, 0x240ca1cc, 0x2de92c6f,
+    0x4a7484aa, 0x5cb0a9dc, 0x76f988da, 0x983e5152, 0xa831c66d, 0xb00327c8, 0xbf597fc7,
+    0xc6e00bf3, 0xd5a79147, 0x06ca6351, 0x14292967, 0x27b70a85, 0x2e1b2138, 0x4d2c6dfc,
+    0x53380d13, 0x650a7354, 0x766a0abb, 0x81c2c92e, 0x92722c85, 0xa2bfe8a1, 0xa81a664b,
+    0xc24b8b70, 0xc76c51a3, 0xd192e819, 0xd6990624, 0xf40e3585, 0x106aa070, 0x19a4c116,
+    0x1e376c08, 0x2748774c, 0x34b0bcb5, 0x391c0cb3, 0x4ed8aa4a, 0x5b9cca4f, 0x682e6ff3,
+    0x748f82ee, 0x78a5636f, 0x84c87814, 0x8cc70208, 0x90befffa, 0xa4506ceb, 0xbef9a3f7,
+    0xc67178f2};
+
+static const uint32_t IV[8] = {0x6a09e667,
+                               0xbb67ae85,
+                               0x3c6ef372,
+                               0xa54ff53a,
+                               0x510e527f,
+                               0x9b05688c,
+                               0x1f83d9ab,
+                               0x5be0cd19};
+
+static SHA256_INLINE uint32_t LoadBigEndian(const uint8_t* p)
+{
+    return (uint32_t(p[0]) << 24) | (uint32_t(p[1]) << 16) | (uint32_t(p[2]) << 8) | p[3];
+}
+
+static SHA256_INLINE void StoreBigEndian(uint8_t* p, uint32_t x)
+{
+    p[0] = uint8_t(x >> 24);
+    p[1] = uint8_t(x >> 16);
+    p[2] = uint8_t(x >> 8);
+    p[3] = uint8_t(x);
+}
+
+// Number of 32-bit lanes in a word type: 1 for uint32_t, 4 or 8 for vectors
+template <typename V>
+struct Lanes
+{
+    static const size_t COUNT = sizeof(V) / sizeof(uint32_t);
+};
+
+// Rotation written out so it applies to scalars and vectors alike; helper
+// functions taking vectors by value would trip the psABI warnings for AVX
+// types outside the AVX2 entry point
+#define SHA256_ROTR(x, n) (((x) >> (n)) | ((x) << (32 - (n))))
+
+// One SHA-256 compression of the 16-word block `w` (overwritten) into `state`
+template <typename V>
+static SHA256_INLINE void Compress(V* state, V* w)
+{
+    V a = state[0], b = state[1], c = state[2], d = state[3];
+    V e = state[4], f = state[5], g = state[6], h = state[7];
+    for (int t = 0; t < 64; t++)
+    {
+        if (t >= 16)
+        {
+            V w15 = w[(t - 15) & 15];
+            V w2 = w[(t - 2) & 15];
+            V s0 = SHA256_ROTR(w15, 7) ^ SHA256_ROTR(w15, 18) ^ (w15 >> 3);
+            V s1 = SHA256_ROTR(w2, 17) ^ SHA256_ROTR(w2, 19) ^ (w2 >> 10);
+            w[t & 15] += s0 + w[(t - 7) & 15] + s1;
+        }
+        V sigma1 = SHA256_ROTR(e, 6) ^ SHA256_ROTR(e, 11) ^ SHA256_ROTR(e, 25);
+        V sigma0 = SHA256_ROTR(a, 2) ^ SHA256_ROTR(a, 13) ^ SHA256_ROTR(a, 22);
+        V t1 = h + sigma1 + (g ^ (e & (f ^ g))) + K[t] + w[t & 15];
+        V t2 = sigma0 + ((a & b) | (c & (a | b)));
+        h = g;
+        g = f;
+        f = e;
+        e = d + t1;
+        d = c;
+        c = b;
+        b = a;
+        a = t1 + t2;
+    }
+    state[0] += a;
+    state[1] += b;
+    state[2] += c;
+    state[3] += d;
+    state[4] += e;
+    state[5] += f;
+    state[6] += g;
+    state[7] += h;
+}
+
+// Gathers big-endian word `word` of every lane's header into one vector
+template <typename V>
+static SHA256_INLINE void LoadHeaderWord(V& v, const uint8_t* headers, size_t word)
+{
+    uint32_t lanes[Lanes<V>::COUNT];
+    for (size_t lane = 0; lane < Lanes<V>::COUNT; lane++)
+    {
+        lanes[lane] = LoadBigEndian(headers + lane * SHA256_HEADER_SIZE + word * 4);
+    }
+    std::memcpy(&v, lanes, sizeof(v));
+}
+
+// Double SHA-256 of one 80-byte header per lane
+template <typename V>
+static SHA256_INLINE void Sha256dLanes(const uint8_t* headers, uint8_t* digests)
+{
+    V state[8];
+    V w[16];
+    for (int i = 0; i < 8; i++)
+    {
+        state[i] = V() + IV[i];
+    }
+    for (int i = 0; i < 16; i++)
+    {
+        LoadHeaderWord(w[i], headers, i);
+    }
+    Compress(state, w);
+
+    // Last 16 header bytes, then padding for an 80-byte (640-bit) message
+    for (int i = 0; i < 4; i++)
+    {
+        LoadHeaderWord(w[i], headers, 16 + i);
+    }
+    w[4] = V() + 0x80000000;
+    for (int i = 5; i < 15; i++)
+    {
+        w[i] = V();
+    }
+    w[15] = V() + 640;
+    Compress(state, w);
+
+    // The first digest, as big-endian words, is the whole 256-bit second message
+    for (int i = 0; i < 8; i++)
+    {
+        w[i] = state[i];
+        state[i] = V() + IV[i];
+    }
+    w[8] = V() + 0x80000000;
+    for (int i = 9; i < 15; i++)
+    {
+        w[i] = V();
+    }
+    w[15] = V() + 256;
+    Compress(state, w);
+
+    for (int i = 0; i < 8; i++)
+    {
+        uint32_t lanes[Lanes<V>::COUNT];
+        std::memcpy(lanes, &state[i], sizeof(lanes));
+        for (size_t lane = 0; lane < Lanes<V>::COUNT; lane++)
+        {
+            StoreBigEndian(digests + lane * SHA256_DIGEST_SIZE + i * 4, lanes[lane]);
+        }
+    }
+}
+
+static void Sha256dScalar(const uint8_t* header, uint8_t* digest)
+{
+    Sha256dLanes<uint32_t>(header, digest);
+}
+
+#ifdef SHA256_X86
+typedef uint32_t Words4 __attribute__((vector_size(16)));
+typedef uint32_t Words8 __attribute__((vector_size(32)));
+
+__attribute__((target("sse4.1"))) static void Sha256dSse41(const uint8_t* headers,
+                                                           uint8_t* digests)
+{
+    Sha256dLanes<Words4>(headers, digests);
+}
+
+__attribute__((target("avx2"))) static void Sha256dAvx2(const uint8_t* headers, uint8_t* digests)
+{
+    Sha256dLanes<Words8>(headers, digests);
+}
+
+// One pass of a vector kernel over a full group of lanes
+static void Sha256dVector(Sha256Kernel kernel, const uint8_t* headers, uint8_t* digests)
+{
+    if (kernel == Sha256Kernel::Avx2)
+    {
+        Sha256dAvx2(headers, digests);
+    }
+    else
+    {
+        Sha256dSse41(headers, digests);
+    }
+}
+#endif
+
+bool Sha256KernelSupported(Sha256Kernel kernel)
+{
+    switch (kernel)
+    {
+    case Sha256Kernel::Scalar:
+        return true;
+#ifdef SHA256_X86
+    case Sha256Kernel::Sse41:
+        return __builtin_cpu_supports("sse4.1");
+    case Sha256Kernel::Avx2:
+        return __builtin_cpu_supports("avx2");
+#endif
+    default:
+        return false;
+    }
+}
+
+Sha256Kernel Sha256BestKernel()
+{
+    for (Sha256Kernel kernel : {Sha256Kernel::Avx2, Sha256Kernel::Sse41})
+    {
+        if (Sha256KernelSupported(kernel))
+        {
+            return kernel;
+        }
+    }
+    return Sha256Kernel::Scalar;
+}
+
+bool Sha256KernelFromName(const std::string& name, Sha256Kernel& kernel)
+{
+    if (name == "auto")
+    {
+        kernel = Sha256BestKernel();
+        return true;
+    }
+    for (Sha256Kernel candidate : {Sha256Kernel::Scalar, Sha256Kernel::Sse41, Sha256Kernel::Avx2})
+    {
+        if (name == Sha256KernelName(candidate))
+        {
+            kernel = candidate;
+            return true;
+        }
+    }
+    return false;
+}
+
+const char* Sha256KernelName(Sha256Kernel kernel)
+{
+    switch (kernel)
+    {
+    case Sha256Kernel::Sse41:
+        return "sse41";
+    case Sha256Kernel::Avx2:
+        return "avx2";
+    default:
+        return "scalar";
+    }
+}
+
+uint32_t Sha256KernelLanes(Sha256Kernel kernel)
+{
+    switch (kernel)
+    {
+    case Sha256Kernel::Sse41:
+        return 4;
+    case Sha256Kernel::Avx2:
+        return 8;
+    default:
+        return 1;
+    }
+}
+
+void Sha256dHeaders(Sha256Kernel kernel, const uint8_t* headers, size_t count, uint8_t* digests)
+{
+    size_t lanes = Sha256KernelLanes(kernel);
+    size_t i = 0;
+#ifdef SHA256_X86
+    for (; lanes > 1 && i + lanes <= count; i += lanes)
+    {
+        Sha256dVector(kernel, headers + i * SHA256_HEADER_SIZE, digests + i * SHA256_DIGEST_SIZE);
+    }
+    // A vector pass costs about two scalar hashes, so two or more leftover
+    // headers are padded out to a full pass instead
+    if (lanes > 1 && count - i >= 2)
+    {
+        uint8_t paddedHeaders[8 * SHA256_HEADER_SIZE] = {};
+        uint8_t paddedDigests[8 * SHA256_DIGEST_SIZE];
+        size_t rest = count - i;
+        std::memcpy(paddedHeaders, headers + i * SHA256_HEADER_SIZE, rest * SHA256_HEADER_SIZE);
+        Sha256dVector(kernel, paddedHeaders, paddedDigests);
+        std::memcpy(digests + i * SHA256_DIGEST_SIZE, paddedDigests, rest * SHA256_DIGEST_SIZE);
+        return;
+    }
+#endif
+    for (; i < count; i++)
+    {
+        Sha256dScalar(headers + i * SHA256_HEADER_SIZE, digests + i * SHA256_DIGEST_SIZE);
+    }
+}
@@ -0,0 +1,44 @@
+#ifndef SHA256_H
+#define SHA256_H
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+// Double SHA-256 of fixed 80-byte block headers, as used for proof-of-work.
+// Besides the scalar code there are multi-buffer kernels that hash 4 (SSE4.1)
+// or 8 (AVX2) independent headers at once, one header per 32-bit vector lane;
+// the kernel is picked at run time from what the CPU supports.
+
+// Size of a block header and of a digest in bytes
+const size_t SHA256_HEADER_SIZE = 80;
+const size_t SHA256_DIGEST_SIZE = 32;
+
+enum class Sha256Kernel
+{
+    Scalar,
+    Sse41,
+    Avx2
+};
+
+// Returns the widest kernel the CPU supports
+Sha256Kernel Sha256BestKernel();
+
+// Returns true if the CPU can run the kernel
+bool Sha256KernelSupported(Sha256Kernel kernel);
+
+// Parses scalar, sse41, avx2 or auto (the best supported); returns false for other names
+bool Sha256KernelFromName(const std::string& name, Sha256Kernel& kernel);
+
+// Returns the kernel's name as accepted by Sha256KernelFromName
+const char* Sha256KernelName(Sha256Kernel kernel);
+
+// Returns how many headers the kernel hashes per pass
+uint32_t Sha256KernelLanes(Sha256Kernel kernel);
+
+// Double SHA-256 of `count` consecutive 80-byte headers into `count`
+// consecutive 32-byte digests; full groups of lanes go through the kernel, the
+// remainder through the scalar code
+void Sha256dHeaders(Sha256Kernel kernel, const uint8_t* headers, size_t count, uint8_t* digests);
+
+#endif
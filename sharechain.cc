@@ -0,0 +1,211 @@
+#include "sharechain.h"
+
+#include <algorithm>
+
+ShareChain::ShareChain(uint32_t numNodes)
+    : records(1, Record{Share{UNKNOWN_PEER, 0, 0.0, 0, NO_PARENT}, 0, 0}),
+      views(numNodes),
+      fetchTimeout(MilliSeconds(500)),
+      fetchAttempts(3),
+      orphanCount(0)
+{
+}
+
+uint64_t ShareChain::Key(const Share& share)
+{
+    return (static_cast<uint64_t>(share.originNodeId) << 32) | share.shareId;
+}
+
+bool ShareChain::IsAncestor(uint32_t ancestor, uint32_t descendant) const
+{
+    while (records[descendant].height > records[ancestor].height)
+    {
+        descendant = records[descendant].share.parent;
+    }
+    return descendant == ancestor;
+}
+
+void ShareChain::SetFetchPolicy(Time timeout, uint32_t attempts)
+{
+    fetchTimeout = timeout;
+    fetchAttempts = attempts;
+}
+
+Time ShareChain::GetFetchTimeout() const
+{
+    return fetchTimeout;
+}
+
+uint32_t ShareChain::GetFetchAttempts() const
+{
+    return fetchAttempts;
+}
+
+uint32_t ShareChain::GetTip(uint32_t node) const
+{
+    return views[node].tip;
+}
+
+void ShareChain::OnShareGenerated(uint32_t node, const Share& share)
+{
+    // Mined shares are stored with their nonce, so GETSHARE answers pass validation
+    uint32_t parent = share.parent;
+    uint32_t self = static_cast<uint32_t>(records.size());
+    records.push_back(Record{share, records[parent].height + 1, 0});
+    records[parent].children++;
+    index[Key(share)] = self;
+    views[node].tip = self;
+}
+
+void ShareChain::OnShareAccepted(uint32_t node, const Share& share)
+{
+    auto it = index.find(Key(share));
+    if (it == index.end())
+    {
+        return;
+    }
+    NodeView& view = views[node];
+    if (records[it->second].height <= records[view.tip].height)
+    {
+        return;
+    }
+    if (!IsAncestor(view.tip, it->second))
+    {
+        view.reorgs++;
+    }
+    view.tip = it->second;
+}
+
+const Share& ShareChain::GetShare(uint32_t record) const
+{
+    return records[record].share;
+}
+
+uint32_t ShareChain::GetRecord(const Share& share) const
+{
+    auto it = index.find(Key(share));
+    return it != index.end() ? it->second : NO_PARENT;
+}
+
+void ShareChain::OnOrphanBuffered()
+{
+    fetch.orphans++;
+    orphanCount++;
+    fetch.peakOrphans = std::max(fetch.peakOrphans, orphanCount);
+}
+
+void ShareChain::OnOrphansRemoved(size_t count, bool dropped)
+{
+    orphanCount -= count;
+    if (dropped)
+    {
+        fetch.dropped += count;
+    }
+}
+
+void ShareChain::OnRequestSent(bool retry)
+{
+    fetch.requests++;
+    if (retry)
+    {
+        fetch.retries++;
+    }
+}
+
+void ShareChain::OnRequestCompleted(Time latency)
+{
+    fetch.latency.Add(latency.GetSeconds());
+    fetch.latencyHistogram.Add(latency.GetSeconds());
+}
+
+void ShareChain::OnRequestFailed()
+{
+    fetch.failures++;
+}
+
+void ShareChain::OnShareServed()
+{
+    fetch.served++;
+}
+
+const ShareChain::FetchStats& ShareChain::GetFetchStats() const
+{
+    return fetch;
+}
+
+void ShareChain::Reset()
+{
+    records.assign(1, Record{Share{UNKNOWN_PEER, 0, 0.0, 0, NO_PARENT}, 0, 0});
+    index.clear();
+    views.assign(views.size(), NodeView());
+    orphanCount = 0;
+    fetch = FetchStats();
+}
+
+uint32_t ShareChain::GetNodeReorgs(uint32_t node) const
+{
+    return views[node].reorgs;
+}
+
+uint32_t ShareChain::GetShareCount() const
+{
+    return static_cast<uint32_t>(records.size() - 1);
+}
+
+ShareChain::Summary ShareChain::Analyze(uint32_t confirmations) const
+{
+    Summary summary;
+    summary.settledByOrigin.assign(views.size(), 0);
+    summary.staleByOrigin.assign(views.size(), 0);
+
+    // Records are in creation order, so the first highest one won its height
+    uint32_t best = 0;
+    for (uint32_t i = 1; i < records.size(); i++)
+    {
+        if (records[i].height > records[best].height)
+        {
+            best = i;
+        }
+    }
+    summary.mainHeight = records[best].height;
+    std::vector<bool> onMain(records.size(), false);
+    for (uint32_t i = best; i != NO_PARENT; i = records[i].share.parent)
+    {
+        onMain[i] = true;
+    }
+
+    if (summary.mainHeight <= confirmations)
+    {
+        return summary;
+    }
+    uint32_t settledHeight = summary.mainHeight - confirmations;
+    uint32_t settledMain = 0;
+    for (uint32_t i = 1; i < records.size(); i++)
+    {
+        const Record& record = records[i];
+        if (record.height > settledHeight)
+        {
+            continue;
+        }
+        summary.settledShares++;
+        summary.settledByOrigin[record.share.originNodeId]++;
+        if (onMain[i])
+        {
+            settledMain++;
+        }
+        else
+        {
+            summary.staleShares++;
+            summary.staleByOrigin[record.share.originNodeId]++;
+        }
+        if (record.children > 1)
+        {
+            summary.forks++;
+        }
+    }
+    summary.staleRate =
+        summary.settledShares > 0 ? static_cast<double>(summary.staleShares) / summary.settledShares
+                                  : 0.0;
+    summary.forkRate = settledMain > 0 ? static_cast<double>(summary.forks) / settledMain : 0.0;
+    return summary;
+}
@@ -0,0 +1,149 @@
+#ifndef SHARE_CHAIN_H
+#define SHARE_CHAIN_H
+
+#include "p2ptypes.h"
+#include "statistics.h"
+
+#include <unordered_map>
+#include <vector>
+
+using namespace ns3;
+
+// Sharechain: every generated share builds on its miner's current best tip,
+// so shares form a tree rooted at a genesis share. A share that loses a race
+// against a share at the same height propagating faster ends up off the main
+// chain and is stale, which is what slow propagation costs miners.
+//
+// The records are immutable once created and shared by all nodes in one
+// append-only store; a record's index stands in for the share hash that real
+// shares reference, and the parent index travels with the share. A node's
+// local view is the chain ending at its tip, so per-node state is just the
+// tip and a reorg counter rather than a copy of the chain.
+//
+// A node that receives a share before its parent cannot connect it: the share
+// waits in the node's orphan buffer while the node fetches the parent from a
+// peer with GETSHARE. The buffers and the requests in flight belong to the
+// node; the chain holds the fetch policy and counts the protocol over all
+// nodes.
+class ShareChain
+{
+  public:
+    // Outcome of the fork analysis over the settled part of the tree
+    struct Summary
+    {
+        uint32_t settledShares = 0; // shares at least `confirmations` below the best tip
+        uint32_t staleShares = 0;   // settled shares off the main chain
+        uint32_t forks = 0;         // settled shares with more than one child
+        uint32_t mainHeight = 0;
+        double staleRate = 0.0;
+        double forkRate = 0.0;      // forks per settled main-chain share
+        // Settled and stale shares per originating node
+        std::vector<uint32_t> settledByOrigin;
+        std::vector<uint32_t> staleByOrigin;
+    };
+
+    // Missing-parent fetch counters over all nodes
+    struct FetchStats
+    {
+        uint64_t requests = 0; // GETSHARE messages sent, retries included
+        uint64_t retries = 0;
+        uint64_t failures = 0; // parents given up on after the last attempt timed out
+        uint64_t served = 0;   // GETSHARE requests answered with the share
+        uint64_t orphans = 0;  // shares that had to wait for their parent
+        uint64_t dropped = 0;  // orphans discarded with a failed fetch
+        size_t peakOrphans = 0; // most orphans buffered at once, over all nodes
+        SampleStats latency;    // first request until the parent is connected, in seconds
+        LogHistogram latencyHistogram;
+    };
+
+  private:
+    struct Record
+    {
+        Share share; // share.parent is the parent record
+        uint32_t height;
+        uint32_t children;
+    };
+
+    // Per-node view: the tip a node mines on and how often it abandoned one
+    struct NodeView
+    {
+        uint32_t tip = 0;
+        uint32_t reorgs = 0;
+    };
+
+    std::vector<Record> records; // index 0 is the genesis share
+    std::unordered_map<uint64_t, uint32_t> index;
+    std::vector<NodeView> views;
+    Time fetchTimeout;
+    uint32_t fetchAttempts;
+    size_t orphanCount;
+    FetchStats fetch;
+
+    static uint64_t Key(const Share& share);
+
+    // Returns true if `ancestor` is on the chain ending at `descendant`
+    bool IsAncestor(uint32_t ancestor, uint32_t descendant) const;
+
+  public:
+    ShareChain(uint32_t numNodes);
+
+    // Sets how long a node waits for a GETSHARE answer and how many peers it asks
+    void SetFetchPolicy(Time timeout, uint32_t attempts);
+
+    Time GetFetchTimeout() const;
+    uint32_t GetFetchAttempts() const;
+
+    // Returns the record of the node's tip, the parent of the next share it generates
+    uint32_t GetTip(uint32_t node) const;
+
+    // Records a share the node generated on its tip (share.parent) as the new tip
+    void OnShareGenerated(uint32_t node, const Share& share);
+
+    // Adopts a received share as the node's tip if it is higher than the
+    // current one (longest chain wins, the first seen wins ties)
+    void OnShareAccepted(uint32_t node, const Share& share);
+
+    // Returns the share stored for a record
+    const Share& GetShare(uint32_t record) const;
+
+    // Returns the record of a generated share, or NO_PARENT if it is unknown
+    uint32_t GetRecord(const Share& share) const;
+
+    // Counts a share a node buffered until its parent arrives
+    void OnOrphanBuffered();
+
+    // Counts orphans a node released after connecting their parent, or
+    // discarded with a failed fetch when `dropped` is set
+    void OnOrphansRemoved(size_t count, bool dropped);
+
+    // Counts a GETSHARE a node sent, `retry` if it asked another peer for the same parent
+    void OnRequestSent(bool retry);
+
+    // Counts a parent that arrived `latency` after the node first requested it
+    void OnRequestCompleted(Time latency);
+
+    // Counts a parent a node gave up on
+    void OnRequestFailed();
+
+    // Counts a GETSHARE answered by a node
+    void OnShareServed();
+
+    // Returns the fetch counters
+    const FetchStats& GetFetchStats() const;
+
+    // Forgets all shares and counters; every node mines on the genesis share again
+    void Reset();
+
+    // Returns how many times the node switched to a tip not built on its previous one
+    uint32_t GetNodeReorgs(uint32_t node) const;
+
+    // Returns the number of generated shares
+    uint32_t GetShareCount() const;
+
+    // Finds the main chain (the ancestry of the highest tip, earliest created
+    // on ties) and counts stale shares and forks among shares at least
+    // `confirmations` below its tip; shares above that may still be reorged
+    Summary Analyze(uint32_t confirmations) const;
+};
+
+#endif
@@ -0,0 +1,158 @@
+#include "statistics.h"
+
+#include <algorithm>
+#include <cmath>
+
+SampleStats::SampleStats()
+    : count(0),
+      mean(0.0),
+      m2(0.0)
+{
+}
+
+void SampleStats::Add(double value)
+{
+    count++;
+    double delta = value - mean;
+    mean += delta / count;
+    m2 += delta * (value - mean);
+}
+
+void SampleStats::Reset()
+{
+    count = 0;
+    mean = 0.0;
+    m2 = 0.0;
+}
+
+uint64_t SampleStats::GetCount() const
+{
+    return count;
+}
+
+double SampleStats::GetMean() const
+{
+    return mean;
+}
+
+double SampleStats::GetVariance() const
+{
+    return count > 1 ? m2 / (count - 1) : 0.0;
+}
+
+double SampleStats::GetHalfWidth(double confidence) const
+{
+    if (count < 2)
+    {
+        return 0.0;
+    }
+    double t = StudentTQuantile(0.5 + confidence / 2.0, count - 1);
+    return t * std::sqrt(GetVariance() / count);
+}
+
+LogHistogram::LogHistogram(double minValue, double maxValue, double relativeWidth)
+    : minValue(minValue),
+      logGrowth(std::log1p(relativeWidth)),
+      bins(static_cast<size_t>(std::ceil(std::log(maxValue / minValue) / logGrowth)) + 1, 0),
+      count(0)
+{
+}
+
+void LogHistogram::Add(double value)
+{
+    size_t bin = 0;
+    if (value > minValue)
+    {
+        bin = std::min(static_cast<size_t>(std::log(value / minValue) / logGrowth),
+                       bins.size() - 1);
+    }
+    bins[bin]++;
+    count++;
+}
+
+void LogHistogram::Reset()
+{
+    std::fill(bins.begin(), bins.end(), 0);
+    count = 0;
+}
+
+uint64_t LogHistogram::GetCount() const
+{
+    return count;
+}
+
+double LogHistogram::GetQuantile(double p) const
+{
+    if (count == 0)
+    {
+        return 0.0;
+    }
+    // Rank of the quantile among the sorted observations, counting from 1
+    uint64_t rank = std::max<uint64_t>(1, static_cast<uint64_t>(std::ceil(p * count)));
+    uint64_t seen = 0;
+    for (size_t bin = 0; bin < bins.size(); bin++)
+    {
+        seen += bins[bin];
+        if (seen >= rank)
+        {
+            return minValue * std::exp((bin + 0.5) * logGrowth);
+        }
+    }
+    return minValue * std::exp((bins.size() - 0.5) * logGrowth);
+}
+
+double NormalQuantile(double p)
+{
+    // Rational approximation by P. J. Acklam, relative error below 1.2e-9
+    static const double a[] = {-3.969683028665376e+01, 2.209460984245205e+02,
+                               -2.759285104469687e+02, 1.383577518672690e+02,
+                               -3.066479806614716e+01, 2.506628277459239e+00};
+    static const double b[] = {-5.447609879822406e+01, 1.615858368580409e+02,
+                               -1.556989798598866e+02, 6.680131188771972e+01,
+                               -1.328068155288572e+01};
+    static const double c[] = {-7.784894002430293e-03, -3.223964580411365e-01,
+                               -2.400758277161838e+00, -2.549732539343734e+00,
+                               4.374664141464968e+00,  2.938163982698783e+00};
+    static const double d[] = {7.784695709041462e-03, 3.224671290700398e-01,
+                               2.445134137142996e+00, 3.754408661907416e+00};
+    static const double low = 0.02425;
+
+    if (p < low)
+    {
+        double q = std::sqrt(-2 * std::log(p));
+        return (((((c[0] * q + c[1]) * q + c[2]) * q + c[3]) * q + c[4]) * q + c[5]) /
+               ((((d[0] * q + d[1]) * q + d[2]) * q + d[3]) * q + 1);
+    }
+    if (p > 1 - low)
+    {
+        double q = std::sqrt(-2 * std::log(1 - p));
+        return -(((((c[0] * q + c[1]) * q + c[2]) * q + c[3]) * q + c[4]) * q + c[5]) /
+               ((((d[0] * q + d[1]) * q + d[2]) * q + d[3]) * q + 1);
+    }
+    double q = p - 0.5;
+    double r = q * q;
+    return (((((a[0] * r + a[1]) * r + a[2]) * r + a[3]) * r + a[4]) * r + a[5]) * q /
+           (((((b[0] * r + b[1]) * r + b[2]) * r + b[3]) * r + b[4]) * r + 1);
+}
+
+double StudentTQuantile(double p, uint64_t degreesOfFreedom)
+{
+    double n = static_cast<double>(degreesOfFreedom);
+    if (degreesOfFreedom == 1)
+    {
+        return std::tan(M_PI * (p - 0.5));
+    }
+    if (degreesOfFreedom == 2)
+    {
+        double alpha = 4 * p * (1 - p);
+        return 2 * (p - 0.5) * std::sqrt(2 / alpha);
+    }
+    // Cornish-Fisher expansion around the normal quantile (within 1% for 3+ degrees of freedom)
+    double z = NormalQuantile(p);
+    double z2 = z * z;
+    double g1 = (z2 + 1) * z / 4;
+    double g2 = ((5 * z2 + 16) * z2 + 3) * z / 96;
+    double g3 = (((3 * z2 + 19) * z2 + 17) * z2 - 15) * z / 384;
+    double g4 = ((((79 * z2 + 776) * z2 + 1482) * z2 - 1920) * z2 - 945) * z / 92160;
+    return z + g1 / n + g2 / (n * n) + g3 / (n * n * n) + g4 / (n * n * n * n);
+}
@@ -0,0 +1,68 @@
+#ifndef STATISTICS_H
+#define STATISTICS_H
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+// Running mean and variance of a sample (Welford's algorithm)
+class SampleStats
+{
+  private:
+    uint64_t count;
+    double mean;
+    double m2;
+
+  public:
+    SampleStats();
+
+    // Adds one observation
+    void Add(double value);
+
+    // Forgets all observations
+    void Reset();
+
+    uint64_t GetCount() const;
+    double GetMean() const;
+
+    // Returns the unbiased sample variance (0 with fewer than two observations)
+    double GetVariance() const;
+
+    // Returns the half-width of the two-sided Student-t confidence interval of the mean
+    double GetHalfWidth(double confidence = 0.95) const;
+};
+
+// Histogram of positive values in logarithmic bins, giving quantiles with
+// bounded memory; each bin spans the same relative width, so a quantile is
+// accurate to about half that width. Values outside the range are clamped.
+class LogHistogram
+{
+  private:
+    double minValue;
+    double logGrowth;
+    std::vector<uint64_t> bins;
+    uint64_t count;
+
+  public:
+    LogHistogram(double minValue = 1e-6, double maxValue = 1e3, double relativeWidth = 0.01);
+
+    // Adds one observation
+    void Add(double value);
+
+    // Forgets all observations
+    void Reset();
+
+    uint64_t GetCount() const;
+
+    // Returns the p-quantile (0 <= p <= 1) as the geometric centre of its bin,
+    // or 0 when empty
+    double GetQuantile(double p) const;
+};
+
+// Returns the p-quantile of the standard normal distribution
+double NormalQuantile(double p);
+
+// Returns the p-quantile of Student's t distribution with the given degrees of freedom
+double StudentTQuantile(double p, uint64_t degreesOfFreedom);
+
+#endif
@@ -0,0 +1,101 @@
+#include "stoppingrule.h"
+
+#include "statistics.h"
+
+#include <algorithm>
+#include <cmath>
+
+SequentialStoppingRule::SequentialStoppingRule(double relativePrecision,
+                                               double confidence,
+                                               uint32_t minBatches)
+    : relativePrecision(relativePrecision),
+      confidence(confidence),
+      minBatches(minBatches),
+      warmupBatches(0)
+{
+}
+
+void SequentialStoppingRule::AddBatch(double latency, double coverage)
+{
+    latencyBatches.push_back(latency);
+    coverageBatches.push_back(coverage);
+}
+
+uint32_t SequentialStoppingRule::MserTruncation(const std::vector<double>& series)
+{
+    size_t n = series.size();
+    if (n < 2)
+    {
+        return 0;
+    }
+
+    // Suffix sums give the mean and squared deviations of every tail in O(n)
+    std::vector<double> sum(n + 1, 0.0);
+    std::vector<double> sumSquares(n + 1, 0.0);
+    for (size_t i = n; i-- > 0;)
+    {
+        sum[i] = sum[i + 1] + series[i];
+        sumSquares[i] = sumSquares[i + 1] + series[i] * series[i];
+    }
+
+    uint32_t best = 0;
+    double bestScore = 0.0;
+    for (size_t d = 0; d <= n / 2; d++)
+    {
+        double remaining = static_cast<double>(n - d);
+        double deviations = sumSquares[d] - sum[d] * sum[d] / remaining;
+        double score = deviations / (remaining * remaining);
+        if (d == 0 || score < bestScore)
+        {
+            bestScore = score;
+            best = static_cast<uint32_t>(d);
+        }
+    }
+    return best;
+}
+
+SequentialStoppingRule::Estimate SequentialStoppingRule::Summarize(
+    const std::vector<double>& series) const
+{
+    SampleStats stats;
+    for (size_t i = warmupBatches; i < series.size(); i++)
+    {
+        stats.Add(series[i]);
+    }
+    return Estimate{stats.GetMean(),
+                    stats.GetHalfWidth(confidence),
+                    static_cast<uint32_t>(stats.GetCount())};
+}
+
+bool SequentialStoppingRule::IsPrecise(const Estimate& estimate) const
+{
+    return estimate.batches >= minBatches &&
+           estimate.halfWidth <= relativePrecision * std::fabs(estimate.mean);
+}
+
+bool SequentialStoppingRule::IsSatisfied()
+{
+    warmupBatches =
+        std::max(MserTruncation(latencyBatches), MserTruncation(coverageBatches));
+    return IsPrecise(GetLatencyEstimate()) && IsPrecise(GetCoverageEstimate());
+}
+
+uint32_t SequentialStoppingRule::GetWarmupBatches() const
+{
+    return warmupBatches;
+}
+
+uint32_t SequentialStoppingRule::GetBatchCount() const
+{
+    return static_cast<uint32_t>(latencyBatches.size());
+}
+
+SequentialStoppingRule::Estimate SequentialStoppingRule::GetLatencyEstimate() const
+{
+    return Summarize(latencyBatches);
+}
+
+SequentialStoppingRule::Estimate SequentialStoppingRule::GetCoverageEstimate() const
+{
+    return Summarize(coverageBatches);
+}
@@ -0,0 +1,60 @@
+#ifndef STOPPING_RULE_H
+#define STOPPING_RULE_H
+
+#include <cstdint>
+#include <vector>
+
+// Sequential stopping rule over batch means of propagation latency and
+// coverage. The warm-up (initial connection phase) is cut with the MSER rule
+// applied to the batch series, and the run may stop once the confidence
+// intervals of both post-warm-up means reach the requested relative precision.
+class SequentialStoppingRule
+{
+  public:
+    // Estimate of one metric from the batches after the warm-up
+    struct Estimate
+    {
+        double mean;
+        double halfWidth;
+        uint32_t batches;
+    };
+
+  private:
+    double relativePrecision;
+    double confidence;
+    uint32_t minBatches;
+    uint32_t warmupBatches;
+    std::vector<double> latencyBatches;
+    std::vector<double> coverageBatches;
+
+    // Returns the MSER truncation point: the number of leading batches whose
+    // removal minimises the standard error of the remaining mean, searched over
+    // the first half of the series
+    static uint32_t MserTruncation(const std::vector<double>& series);
+
+    // Returns the estimate from the batches after the warm-up
+    Estimate Summarize(const std::vector<double>& series) const;
+
+    // Returns true if the estimate's half-width is within the relative precision
+    bool IsPrecise(const Estimate& estimate) const;
+
+  public:
+    SequentialStoppingRule(double relativePrecision, double confidence, uint32_t minBatches);
+
+    // Appends the means of one batch
+    void AddBatch(double latency, double coverage);
+
+    // Recomputes the warm-up and returns true once both estimates are precise enough
+    bool IsSatisfied();
+
+    // Returns the number of leading batches discarded as warm-up
+    uint32_t GetWarmupBatches() const;
+
+    // Returns the number of batches collected, including the warm-up
+    uint32_t GetBatchCount() const;
+
+    Estimate GetLatencyEstimate() const;
+    Estimate GetCoverageEstimate() const;
+};
+
+#endif
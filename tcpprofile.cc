@@ -0,0 +1,46 @@
+#include "tcpprofile.h"
+
+#include "ns3/internet-module.h"
+
+TcpProfile TcpProfileFromName(const std::string& name)
+{
+    if (name == "default")
+    {
+        return TcpProfile{name, true, 536, 131072, 131072, 2, "ns3::TcpNewReno"};
+    }
+    // Nagle's algorithm on: small shares wait for outstanding data to be acknowledged
+    if (name == "nagle")
+    {
+        return TcpProfile{name, false, 536, 131072, 131072, 2, "ns3::TcpNewReno"};
+    }
+    // Every share leaves at once and every segment is acknowledged immediately
+    if (name == "lowlatency")
+    {
+        return TcpProfile{name, true, 1448, 65536, 65536, 1, "ns3::TcpNewReno"};
+    }
+    // Large segments and buffers for throughput
+    if (name == "bulk")
+    {
+        return TcpProfile{name, false, 1448, 1048576, 1048576, 2, "ns3::TcpCubic"};
+    }
+    NS_FATAL_ERROR("Unknown TCP profile '" << name
+                                           << "' (expected default, nagle, lowlatency or bulk)");
+}
+
+void ApplyTcpProfile(Ptr<Socket> socket, const TcpProfile& profile)
+{
+    socket->SetAttribute("TcpNoDelay", BooleanValue(profile.noDelay));
+    socket->SetAttribute("SegmentSize", UintegerValue(profile.segmentSize));
+    socket->SetAttribute("SndBufSize", UintegerValue(profile.sndBufSize));
+    socket->SetAttribute("RcvBufSize", UintegerValue(profile.rcvBufSize));
+    socket->SetAttribute("DelAckCount", UintegerValue(profile.delAckCount));
+
+    Ptr<TcpSocketBase> tcpSocket = DynamicCast<TcpSocketBase>(socket);
+    if (!tcpSocket)
+    {
+        NS_FATAL_ERROR("TCP profiles need a TcpSocketBase socket");
+    }
+    ObjectFactory congestionFactory;
+    congestionFactory.SetTypeId(TypeId::LookupByName(profile.congestionControl));
+    tcpSocket->SetCongestionControlAlgorithm(congestionFactory.Create<TcpCongestionOps>());
+}
@@ -0,0 +1,33 @@
+#ifndef TCP_PROFILE_H
+#define TCP_PROFILE_H
+
+#include "ns3/core-module.h"
+#include "ns3/network-module.h"
+
+#include <string>
+
+using namespace ns3;
+
+// Named set of TCP socket settings applied to every overlay connection of a
+// run. Settings are applied to the dialing socket before it connects and to
+// the listening socket, whose accepted sockets inherit them.
+struct TcpProfile
+{
+    std::string name;
+    bool noDelay;
+    uint32_t segmentSize;
+    uint32_t sndBufSize;
+    uint32_t rcvBufSize;
+    uint32_t delAckCount;
+    // TypeId name of the congestion control algorithm
+    std::string congestionControl;
+};
+
+// Returns the profile with the given name: default (ns-3 defaults), nagle,
+// lowlatency or bulk
+TcpProfile TcpProfileFromName(const std::string& name);
+
+// Applies the profile to a TCP socket that has not connected or listened yet
+void ApplyTcpProfile(Ptr<Socket> socket, const TcpProfile& profile);
+
+#endif